@@ -64,13 +64,18 @@ std::atomic<bool> running{true}, renderUpdate{true};
 
 #include "include/Player.h"
 #include "include/File_Loader.h"
+#include "include/Log_Import.h"
 #include "include/Log_Reader.h"
+#include "include/Skin_Cache.h"
+#include "include/User_Cache.h"
 #include "include/WinAPI_Utils.h"
 
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/daily_file_sink.h>
 
+#include <algorithm>
 #include <chrono>
+#include <filesystem>
 #include <sstream>
 #include <thread>
 
@@ -224,17 +229,20 @@ void renderAllTextures(MPI::PlayerInfoTextures &textures, int height, bool hasEr
                 renderText(textures.stars.symbol, starsTextureXPos, height);
             }
 
+            // seven stats columns, a bit narrower than the others so the last one still fits in the window
             width += 5 * screenWidth * statsFontRatio;
             renderText(textures.FK, width, height);
-            width += 5 * screenWidth * statsFontRatio;
+            width += 4.25 * screenWidth * statsFontRatio;
             renderText(textures.FD, width, height);
-            width += 5 * screenWidth * statsFontRatio;
+            width += 4.25 * screenWidth * statsFontRatio;
             renderText(textures.FKDR, width, height);
-            width += 5 * screenWidth * statsFontRatio;
+            width += 4.25 * screenWidth * statsFontRatio;
+            renderText(textures.BB, width, height);
+            width += 4.25 * screenWidth * statsFontRatio;
             renderText(textures.W, width, height);
-            width += 5 * screenWidth * statsFontRatio;
+            width += 4.25 * screenWidth * statsFontRatio;
             renderText(textures.L, width, height);
-            width += 5 * screenWidth * statsFontRatio;
+            width += 4.25 * screenWidth * statsFontRatio;
             renderText(textures.WLR, width, height);
 
         } else if (FL::config.mode == FL::Mode::MINI_WALLS) {
@@ -266,8 +274,14 @@ std::string to2DPString(float x) {
 }
 
 int main(int argc, char *args[]) {
-    (void)argc;
-    (void)args;
+    // --import-logs: only import the old log archives into the encounter index and exit
+    bool importLogsOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(args[i]) == "--import-logs") {
+            importLogsOnly = true;
+        }
+    }
 
     spdlog::set_pattern("[%Y-%m-%d %H:%M:%S] [%n/%l] %v");
     spdlog::enable_backtrace(32);
@@ -278,6 +292,27 @@ int main(int argc, char *args[]) {
 
     SDL_LogSetOutputFunction(&SDLLogOutputFunction, NULL);
 
+    if (importLogsOnly) {
+        // only the log paths and the chat rules are needed, no window and no Hypixel requests
+        FL::load(false);
+        CP::load();
+
+        // Import the client's old logs (next to latest.log) into the encounter index
+        std::vector<std::string> logDirectories;
+
+        for (const std::string &logFilePath : FL::config.minecraftLogPaths) {
+            std::string logDirectory = std::filesystem::path(logFilePath).parent_path().generic_string();
+
+            if (std::find(logDirectories.begin(), logDirectories.end(), logDirectory) == logDirectories.end()) {
+                logDirectories.push_back(logDirectory);
+            }
+        }
+
+        LI::load();
+        LI::importLogs(logDirectories, std::thread::hardware_concurrency());
+        return 0;
+    }
+
     spdlog::info("Initializing overlay");
     SDL_LogSetAllPriority(SDL_LOG_PRIORITY_DEBUG);
     SDL_SetHint(SDL_HINT_MOUSE_FOCUS_CLICKTHROUGH, "1");
@@ -310,12 +345,28 @@ int main(int argc, char *args[]) {
     titleFontRatio *= scale, statsFontRatio *= scale;
     renderHeadOverlay = FL::config.renderHeadOverlay;
     WAPIUtil::F11Hook::fakeFullscreen = FL::config.fakeFullscreen;
+    HC::maxInFlight = FL::config.maxRequests;
+    HC::hedgeRequests = FL::config.hedgeRequests;
+    MPI::REQUEST_TIMEOUTS[MPI::UUID_REQUEST] = FL::config.uuidTimeout;
+    MPI::REQUEST_TIMEOUTS[MPI::PROFILE_REQUEST] = FL::config.profileTimeout;
+    MPI::REQUEST_TIMEOUTS[MPI::SKIN_REQUEST] = FL::config.skinTimeout;
+    MPI::REQUEST_TIMEOUTS[MPI::DATA_REQUEST] = FL::config.dataTimeout;
 
-    LogParser::logFilePath = FL::config.minecraftLogPath;
-    spdlog::info("Set Minecraft log file path to: {}", FL::config.minecraftLogPath);
+    LogParser::logFilePaths = FL::config.minecraftLogPaths;
+
+    for (const std::string &logFilePath : LogParser::logFilePaths) {
+        spdlog::info("Set Minecraft log file path to: {}", logFilePath);
+    }
 
     FL::write();
 
+    // Load and compile the chat event rules
+    CP::load();
+
+    // UUIDs and skins the clients already know (their usercache.json and assets/skins)
+    UC::open(LogParser::logFilePaths);
+    SC::open(LogParser::logFilePaths);
+
     titleHeight = screenWidth * titleRatio, closeButtonWidth = screenWidth * closeButtonRatio,
     closeButtonPadding = screenWidth * closeButtonPaddingRatio;
 
@@ -436,6 +487,7 @@ int main(int argc, char *args[]) {
         createTextTexture(dummyTextInfo.FK, "FK", statsFont);
         createTextTexture(dummyTextInfo.FD, "FD", statsFont);
         createTextTexture(dummyTextInfo.FKDR, "FKDR", statsFont);
+        createTextTexture(dummyTextInfo.BB, "BB", statsFont);
         createTextTexture(dummyTextInfo.W, "W", statsFont);
         createTextTexture(dummyTextInfo.L, "L", statsFont);
         createTextTexture(dummyTextInfo.WLR, "WLR", statsFont);
@@ -587,16 +639,49 @@ int main(int argc, char *args[]) {
                 renderAllTextures(dummyTextInfo, currentHeight, false);
                 currentHeight += screenWidth * statsFontRatio * 1.5;
 
+                // rows below the bottom of the screen don't need their heads yet
+                int windowY;
+                SDL_Rect displayBounds;
+                SDL_GetWindowPosition(window.get(), NULL, &windowY);
+                SDL_GetDisplayUsableBounds(SDL_GetWindowDisplayIndex(window.get()), &displayBounds);
+                int onScreenHeight = displayBounds.y + displayBounds.h - windowY;
+
                 for (MPI::Player &player : LogParser::players) {
-                    if (!player.updated || !player.render) {
+                    if (!player.render) {
+                        continue;
+                    }
+
+                    // cells the parser thread changed since the last frame
+                    int outdatedCells = player.textures.outdatedCells->exchange(0, std::memory_order_acquire);
+
+                    // the head can arrive before or after the stats, skin is only read once it was handed over
+                    if (outdatedCells & MPI::CELL_SKIN) {
+                        createHeadTexture(player.textures.skin, player.skin);
+                    }
+
+                    if (outdatedCells & MPI::CELL_ROW) {
+                        player.textures.shown = true;
+                        player.textures.init = false;
+                    }
+
+                    if (!player.textures.shown) {
                         continue;
                     }
 
-                    std::string errorMessage;
+                    // start fetching the skin (drawn once it arrives), the log parser may be waiting on the log files
+                    if (FL::config.renderHeads && currentHeight < onScreenHeight && !player.headWanted->load(std::memory_order_relaxed)) {
+                        player.headWanted->store(true, std::memory_order_release);
+                        LogParser::logWatcher.wake();
+                    }
+
+                    std::string errorMessage, retryMessage = player.retryStatus->get();
 
                     if (player.errorMessage.size() > 0) {
                         errorMessage = player.errorMessage;
 
+                    } else if (retryMessage.size() > 0) {
+                        errorMessage = "Retrying (" + retryMessage + ")";
+
                     } else if (player.bedwars.errorMessage.size() > 0) {
                         errorMessage = player.bedwars.errorMessage;
 
@@ -607,28 +692,12 @@ int main(int argc, char *args[]) {
                     if (errorMessage.size() == 0) {
                         if (!player.textures.init) {
                             player.textures.init = true;
-                            createHeadTexture(player.textures.skin, player.skin);
+
                             createTextTexture(player.textures.username, player.username, statsFont);
                             createTextTexture(player.textures.level, std::to_string(player.networkLevel), statsFont);
 
                             if (FL::config.mode == FL::Mode::BEDWARS) {
-                                BWI::info stats;
-
-                                if (FL::config.displayMode == "bw_solos") {
-                                    stats = player.bedwars.solos;
-
-                                } else if (FL::config.displayMode == "bw_doubles") {
-                                    stats = player.bedwars.doubles;
-
-                                } else if (FL::config.displayMode == "bw_threes") {
-                                    stats = player.bedwars.threes;
-
-                                } else if (FL::config.displayMode == "bw_fours") {
-                                    stats = player.bedwars.fours;
-
-                                } else {
-                                    stats = player.bedwars.overall;
-                                }
+                                BWI::info stats = player.bedwars.mode(FL::config.displayMode);
 
                                 if (!player.bedwars.hasMultiStarColor) {
                                     createTextTexture(player.textures.stars.single, std::to_string(player.bedwars.stars), statsFont, player.bedwars.starColor);
@@ -642,6 +711,7 @@ int main(int argc, char *args[]) {
                                 createTextTexture(player.textures.FK, std::to_string(stats.FK), statsFont);
                                 createTextTexture(player.textures.FD, std::to_string(stats.FD), statsFont);
                                 createTextTexture(player.textures.FKDR, to2DPString(stats.FKDR), statsFont);
+                                createTextTexture(player.textures.BB, std::to_string(stats.BB), statsFont);
                                 createTextTexture(player.textures.W, std::to_string(stats.W), statsFont);
                                 createTextTexture(player.textures.L, std::to_string(stats.L), statsFont);
                                 createTextTexture(player.textures.WLR, to2DPString(stats.WLR), statsFont);
@@ -661,6 +731,30 @@ int main(int argc, char *args[]) {
                                 createTextTexture(player.textures.arrowsHit, std::to_string(stats.arrowsHit), statsFont);
                                 createTextTexture(player.textures.AHP, std::to_string(stats.AHP), statsFont);
                             }
+
+                            // everything was just created from the current stats
+                            outdatedCells = 0;
+                        }
+
+                        // only recreate the cells the kill feed changed
+                        if (outdatedCells != 0 && FL::config.mode == FL::Mode::BEDWARS) {
+                            BWI::info stats = player.bedwars.mode(FL::config.displayMode);
+
+                            if (outdatedCells & MPI::CELL_FK) {
+                                createTextTexture(player.textures.FK, std::to_string(stats.FK), statsFont);
+                            }
+
+                            if (outdatedCells & MPI::CELL_FD) {
+                                createTextTexture(player.textures.FD, std::to_string(stats.FD), statsFont);
+                            }
+
+                            if (outdatedCells & MPI::CELL_FKDR) {
+                                createTextTexture(player.textures.FKDR, to2DPString(stats.FKDR), statsFont);
+                            }
+
+                            if (outdatedCells & MPI::CELL_BB) {
+                                createTextTexture(player.textures.BB, std::to_string(stats.BB), statsFont);
+                            }
                         }
 
                         renderAllTextures(player.textures, currentHeight, false);
@@ -669,10 +763,6 @@ int main(int argc, char *args[]) {
                         if (!player.textures.init) {
                             player.textures.init = true;
 
-                            if (player.skin.size() != 0) {
-                                createHeadTexture(player.textures.skin, player.skin);
-                            }
-
                             createTextTexture(player.textures.username, player.username, statsFont);
                             createTextTexture(player.textures.errorMessage, errorMessage, statsFont);
                         }
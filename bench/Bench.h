@@ -0,0 +1,84 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#ifndef BENCH_H
+#define BENCH_H
+
+namespace Bench {
+
+    // Seconds since the timer was created
+    struct Timer {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        double elapsed() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    };
+
+    // Runs function() until at least minTime seconds have passed, returns the average seconds per call
+    template <typename Function>
+    double measure(Function function, double minTime = 0.5) {
+        Timer timer;
+        long long calls = 0;
+
+        do {
+            function();
+            ++calls;
+        } while (timer.elapsed() < minTime);
+
+        return timer.elapsed() / calls;
+    }
+
+    // A line like the ones the game writes to latest.log. About a third of them are chat lines
+    inline std::string logLine(std::mt19937 &rng) {
+        static const char *chat[] = {"Bob has joined (7/16)!", "Bob has quit!", "ONLINE: Alice, Bob, Carol, Dave",
+                                     "[MVP+] Alice: gg", "Carol was killed by Dave. FINAL KILL!", "Sending you to mini123AB!",
+                                     "                                     Bed Wars"};
+        static const char *other[] = {"[Client thread/INFO]: Setting user: Alice",
+                                      "[Client thread/INFO]: Reloading ResourceManager: Default, 1.8.9",
+                                      "[Sound Library Loader/INFO]: Sound engine started",
+                                      "[Client thread/WARN]: Unable to play unknown soundEvent: minecraft:note.pling",
+                                      "[Client thread/INFO]: Connecting to mc.hypixel.net., 25565",
+                                      "[Netty Client IO #3/ERROR]: Error loading chunk for skin texture"};
+
+        char time[16];
+        std::snprintf(time, sizeof(time), "[%02u:%02u:%02u] ", (unsigned)(rng() % 24), (unsigned)(rng() % 60), (unsigned)(rng() % 60));
+
+        if (rng() % 3 == 0) {
+            return std::string(time) + "[Client thread/INFO]: [CHAT] " + chat[rng() % (sizeof(chat) / sizeof(*chat))];
+        }
+
+        return std::string(time) + other[rng() % (sizeof(other) / sizeof(*other))];
+    }
+
+}  // namespace Bench
+
+#endif  // BENCH_H
@@ -0,0 +1,174 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// A local HTTPS stand-in for the APIs: answers every request with a small JSON body after a
+// simulated round trip. New connections pay two more round trips (TCP and TLS 1.3 handshake),
+// so reusing a connection saves the same as it does against the real APIs
+
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifndef HTTPS_SERVER_H
+#define HTTPS_SERVER_H
+
+namespace Bench {
+
+    struct HttpsServer {
+        SSL_CTX *context = NULL;
+        int listener = -1, port = 0;
+        std::chrono::milliseconds roundTrip;
+        std::atomic<long long> connections{0}, requests{0};
+
+        // Writes the (self-signed) certificate to certificatePath for the client to trust
+        HttpsServer(const std::string &certificatePath, std::chrono::milliseconds simulatedRoundTrip) : roundTrip(simulatedRoundTrip) {
+            EVP_PKEY *key = EVP_EC_gen("P-256");
+            X509 *certificate = X509_new();
+
+            X509_set_version(certificate, 2);
+            ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+            X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+            X509_gmtime_adj(X509_getm_notAfter(certificate), 24 * 60 * 60);
+            X509_set_pubkey(certificate, key);
+
+            X509_NAME *name = X509_get_subject_name(certificate);
+            X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)"127.0.0.1", -1, -1, 0);
+            X509_set_issuer_name(certificate, name);
+
+            X509_EXTENSION *extension = X509V3_EXT_conf_nid(NULL, NULL, NID_subject_alt_name, "IP:127.0.0.1");
+            X509_add_ext(certificate, extension, -1);
+            X509_EXTENSION_free(extension);
+
+            X509_sign(certificate, key, EVP_sha256());
+
+            std::FILE *file = std::fopen(certificatePath.c_str(), "wb");
+            PEM_write_X509(file, certificate);
+            std::fclose(file);
+
+            context = SSL_CTX_new(TLS_server_method());
+            SSL_CTX_set_min_proto_version(context, TLS1_3_VERSION);
+            SSL_CTX_use_certificate(context, certificate);
+            SSL_CTX_use_PrivateKey(context, key);
+
+            X509_free(certificate);
+            EVP_PKEY_free(key);
+
+            listener = socket(AF_INET, SOCK_STREAM, 0);
+
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+            socklen_t length = sizeof(address);
+
+            if (bind(listener, (sockaddr *)&address, length) != 0 || listen(listener, 256) != 0 ||
+                getsockname(listener, (sockaddr *)&address, &length) != 0) {
+                throw std::runtime_error("Could not listen on a local port");
+            }
+
+            port = ntohs(address.sin_port);
+
+            // connections (and so their threads) are kept open until the client closes them
+            std::thread([this]() {
+                int connection;
+
+                while ((connection = accept(listener, NULL, NULL)) >= 0) {
+                    int noDelay = 1;
+                    setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+                    ++connections;
+                    std::thread(&HttpsServer::serve, this, connection).detach();
+                }
+            }).detach();
+        }
+
+        std::string url(const std::string &path) const {
+            return "https://127.0.0.1:" + std::to_string(port) + path;
+        }
+
+        void serve(int connection) {
+            // TCP and TLS handshake
+            std::this_thread::sleep_for(2 * roundTrip);
+
+            SSL *ssl = SSL_new(context);
+            SSL_set_fd(ssl, connection);
+
+            if (SSL_accept(ssl) == 1) {
+                std::string data;
+                char buffer[4096];
+                int count;
+
+                while ((count = SSL_read(ssl, buffer, sizeof(buffer))) > 0) {
+                    data.append(buffer, count);
+
+                    std::size_t headerEnd;
+
+                    while ((headerEnd = data.find("\r\n\r\n")) != std::string::npos) {
+                        std::size_t contentLength = 0, field = data.find("Content-Length: ");
+
+                        if (field != std::string::npos && field < headerEnd) {
+                            contentLength = std::stoul(data.substr(field + 16));
+                        }
+
+                        if (data.size() < headerEnd + 4 + contentLength) {
+                            break;
+                        }
+
+                        data.erase(0, headerEnd + 4 + contentLength);
+                        ++requests;
+
+                        std::this_thread::sleep_for(roundTrip);
+
+                        const std::string body = "{\"success\":true,\"player\":{\"displayname\":\"Bob\"}}";
+                        const std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                                                     std::to_string(body.size()) + "\r\n\r\n" + body;
+
+                        SSL_write(ssl, response.data(), response.size());
+                    }
+                }
+            }
+
+            SSL_free(ssl);
+            close(connection);
+        }
+    };
+
+}  // namespace Bench
+
+#endif  // HTTPS_SERVER_H
@@ -0,0 +1,68 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Lines per second through the regex cascade parseLine used to run and through CP::classify
+
+#include "bench/Bench.h"
+#include "include/Chat_Parser.h"
+#include "tests/Chat_Events.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+int main() {
+    CP::automaton = CP::compile(nlohmann::json::parse(CP::DEFAULT_RULES));
+
+    std::mt19937 rng(6);
+    std::vector<std::string> lines;
+
+    while (lines.size() < 20000) {
+        std::string line = Bench::logLine(rng);
+
+        // parseLine only sees the lines that passed the [CHAT] pre-filter
+        if (line.find("[CHAT] ") != std::string::npos) {
+            lines.push_back(line);
+        }
+    }
+
+    std::size_t events = 0;
+
+    double regexTime = Bench::measure([&]() {
+        for (const std::string &line : lines) {
+            events += ChatEvents::fromRegexes(line).size();
+        }
+    }, 2);
+
+    double classifierTime = Bench::measure([&]() {
+        for (const std::string &line : lines) {
+            events += (int)CP::classify(line).event;
+        }
+    }, 2);
+
+    std::printf("%-14s %12.0f lines/s\n", "std::regex", lines.size() / regexTime);
+    std::printf("%-14s %12.0f lines/s\n", "CP::classify", lines.size() / classifierTime);
+    std::printf("speedup %.0fx (%zu)\n", regexTime / classifierTime, events % 10);
+}
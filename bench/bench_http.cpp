@@ -0,0 +1,134 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Requests/second and latency of API requests against a local HTTPS stand-in:
+// one cpr::GetAsync per request, each with a new connection (what MPI::Player used to do),
+// against the HC pool's keep-alive sessions
+
+#include "bench/Bench.h"
+#include "bench/Https_Server.h"
+#include "include/Http_Client.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    std::vector<double> latencies;  // ms
+    double seconds = 0;
+    int failed = 0;
+};
+
+// Sends count requests, one every interval (all at once for 0), and waits for all of them
+template <typename Send>
+Result run(Send send, int count, std::chrono::microseconds interval) {
+    using Future = decltype(send(0));
+
+    std::vector<Future> futures;
+    std::vector<Clock::time_point> sentAt;
+    std::vector<bool> done(count, false);
+    Result result;
+
+    Clock::time_point start = Clock::now();
+    int finished = 0;
+
+    while (finished < count) {
+        Clock::time_point now = Clock::now();
+
+        while ((int)futures.size() < count && now >= start + (long long)futures.size() * interval) {
+            sentAt.push_back(Clock::now());
+            futures.push_back(send(futures.size()));
+        }
+
+        for (std::size_t i = 0; i < futures.size(); ++i) {
+            if (!done[i] && futures[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                done[i] = true;
+                ++finished;
+
+                result.latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - sentAt[i]).count());
+                result.failed += futures[i].get().status_code != 200;
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    return result;
+}
+
+double percentile(std::vector<double> latencies, int p) {
+    std::sort(latencies.begin(), latencies.end());
+    return latencies[(latencies.size() - 1) * p / 100];
+}
+
+// Runs the workload and prints its numbers, with the connections the server had to accept for it
+template <typename Send>
+void report(const char *client, const std::string &workload, Bench::HttpsServer &server, Send send, int count,
+            std::chrono::microseconds interval) {
+    long long connections = server.connections;
+    Result result = run(send, count, interval);
+    connections = server.connections - connections;
+
+    std::printf("%-16s %-24s %9.0f req/s %9.1f ms %9.1f ms %12lld %7d\n", client, workload.c_str(), result.latencies.size() / result.seconds,
+                percentile(result.latencies, 50), percentile(result.latencies, 99), connections, result.failed);
+}
+
+int main() {
+    const std::string certificatePath = "bench_http.crt";
+    setenv("CURL_CA_BUNDLE", certificatePath.c_str(), 1);
+
+    // a /who with 16 players needs about 4 requests per player
+    const int BURST = 64, STEADY = 150;
+
+    std::printf("%-16s %-24s %15s %12s %12s %12s %7s\n", "client", "workload", "throughput", "p50", "p99", "connections", "failed");
+
+    for (int roundTrip : {0, 20}) {
+        Bench::HttpsServer server(certificatePath, std::chrono::milliseconds(roundTrip));
+        const std::string url = server.url("/player");
+
+        std::printf("simulated round trip: %d ms\n", roundTrip);
+
+        auto perRequest = [&](std::size_t i) { return cpr::GetAsync(cpr::Url{url + "?id=" + std::to_string(i)}); };
+        auto pooled = [&](std::size_t i) { return HC::get(url + "?id=" + std::to_string(i)); };
+
+        const std::string burst = std::to_string(BURST) + " at once", steady = std::to_string(STEADY) + ", one every 20 ms";
+        const std::chrono::microseconds now(0), interval(20000);
+
+        report("cpr::GetAsync", burst, server, perRequest, BURST, now);
+        report("cpr::GetAsync", steady, server, perRequest, STEADY, interval);
+        report("HC pool", burst, server, pooled, BURST, now);
+        report("HC pool", steady, server, pooled, STEADY, interval);
+    }
+
+    std::remove(certificatePath.c_str());
+}
@@ -0,0 +1,110 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Throughput of splitting a large log into lines and picking out the chat lines:
+// std::getline into a std::string per line (what readFileUpdates used to do) against
+// LT::Tail with and without its vectorized [CHAT] pre-filter
+
+#include "bench/Bench.h"
+#include "include/Log_Tail.h"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+const long long LOG_SIZE = 128LL * 1024 * 1024;
+
+int main() {
+    const std::string filePath = "bench_scan.log";
+    std::mt19937 rng(3);
+
+    std::string data;
+
+    while ((long long)data.size() < LOG_SIZE) {
+        data += Bench::logLine(rng);
+        data += '\n';
+    }
+
+    std::FILE *file = std::fopen(filePath.c_str(), "wb");
+    std::fwrite(data.data(), 1, data.size(), file);
+    std::fclose(file);
+
+    const double megabytes = data.size() / (1024.0 * 1024.0);
+    data.clear();
+
+    long long expected = -1;
+
+    auto report = [&](const char *name, long long chatLines, double seconds) {
+        if (expected == -1) {
+            expected = chatLines;
+
+        } else if (chatLines != expected) {
+            std::fprintf(stderr, "%s found %lld chat lines instead of %lld\n", name, chatLines, expected);
+            std::exit(1);
+        }
+
+        std::printf("%-26s %10.0f MB/s %12lld chat lines\n", name, megabytes / seconds, chatLines);
+    };
+
+    long long chatLines = 0;
+
+    double getlineTime = Bench::measure([&]() {
+        std::ifstream logFile(filePath);
+        std::string line;
+        chatLines = 0;
+
+        while (std::getline(logFile, line, '\n')) {
+            if (line.find("[CHAT] ") != std::string::npos) {
+                ++chatLines;
+            }
+        }
+    }, 2);
+
+    report("std::getline", chatLines, getlineTime);
+
+    double tailTime = Bench::measure([&]() {
+        LT::Tail tail(filePath);
+        chatLines = 0;
+
+        tail.read([&](std::string_view line) {
+            if (line.find("[CHAT] ") != std::string_view::npos) {
+                ++chatLines;
+            }
+        });
+    }, 2);
+
+    report("LT::Tail", chatLines, tailTime);
+
+    double filteredTime = Bench::measure([&]() {
+        LT::Tail tail(filePath, "[CHAT] ");
+        chatLines = 0;
+
+        tail.read([&](std::string_view) { ++chatLines; });
+    }, 2);
+
+    report("LT::Tail, [CHAT] filter", chatLines, filteredTime);
+
+    std::remove(filePath.c_str());
+}
@@ -0,0 +1,84 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Throughput of the vectorized LT::Search functions against their scalar versions
+// on a log-like buffer (counting newlines and [CHAT] markers)
+
+#include "bench/Bench.h"
+#include "include/Log_Tail.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+template <typename Find>
+long long count(const std::string &data, Find find) {
+    const char *begin = data.data(), *end = begin + data.size();
+    long long matches = 0;
+
+    while ((begin = find(begin, end)) != end) {
+        ++matches;
+        ++begin;
+    }
+
+    return matches;
+}
+
+int main() {
+#if defined(__AVX2__)
+    if (!__builtin_cpu_supports("avx2")) {
+        std::printf("AVX2 is not supported by this CPU\n");
+        return 0;
+    }
+
+    const char *instructions = "AVX2";
+#elif defined(__SSE2__)
+    const char *instructions = "SSE2";
+#else
+    const char *instructions = "scalar";
+#endif
+
+    std::mt19937 rng(8);
+    std::string data;
+
+    while (data.size() < 64 * 1024 * 1024) {
+        data += Bench::logLine(rng);
+        data += '\n';
+    }
+
+    const double megabytes = data.size() / (1024.0 * 1024.0);
+    const std::string_view marker = "[CHAT] ";
+    long long matches = 0;
+
+    auto run = [&](const char *name, auto find) {
+        double time = Bench::measure([&]() { matches = count(data, find); }, 1);
+        std::printf("%-26s %10.0f MB/s %10lld matches\n", name, megabytes / time, matches);
+    };
+
+    std::printf("%s\n", instructions);
+    run("findByteScalar('\\n')", [](const char *begin, const char *end) { return LT::Search::findByteScalar(begin, end, '\n'); });
+    run("findByte('\\n')", [](const char *begin, const char *end) { return LT::Search::findByte(begin, end, '\n'); });
+    run("findStringScalar([CHAT])", [&](const char *begin, const char *end) { return LT::Search::findStringScalar(begin, end, marker); });
+    run("findString([CHAT])", [&](const char *begin, const char *end) { return LT::Search::findString(begin, end, marker); });
+}
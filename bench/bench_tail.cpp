@@ -0,0 +1,125 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Cost of one poll of latest.log as the file grows: rereading the whole file with
+// std::getline (what readFileUpdates used to do) against LT::Tail, which only reads
+// what was appended since the last poll
+
+#include "bench/Bench.h"
+#include "include/Log_Tail.h"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+const int APPENDED_LINES = 20;
+
+// Reopen and skip the lines that were already seen
+struct Reread {
+    std::string filePath;
+    long long previousFileIndex = 0;
+
+    template <typename Callback>
+    void read(Callback callback) {
+        long long currentLineIndex = 0;
+        std::string line;
+        std::ifstream logFile(filePath);
+
+        while (std::getline(logFile, line, '\n')) {
+            if (currentLineIndex >= previousFileIndex) {
+                callback(line);
+            }
+
+            ++currentLineIndex;
+        }
+
+        previousFileIndex = currentLineIndex;
+    }
+};
+
+int main() {
+    const std::string filePath = "bench_tail.log";
+    std::mt19937 rng(1);
+
+    std::printf("%10s %16s %16s %10s\n", "log size", "getline (ms)", "LT::Tail (ms)", "speedup");
+
+    for (long long megabytes : {1, 4, 16, 64}) {
+        std::FILE *file = std::fopen(filePath.c_str(), "wb");
+        std::string data;
+
+        while ((long long)data.size() < megabytes * 1024 * 1024) {
+            data += Bench::logLine(rng);
+            data += '\n';
+        }
+
+        std::fwrite(data.data(), 1, data.size(), file);
+        std::fflush(file);
+
+        Reread reread{filePath};
+        LT::Tail tail(filePath);
+        long long lines = 0;
+        auto count = [&](std::string_view) { ++lines; };
+
+        reread.read(count);
+
+        auto append = [&]() {
+            for (int i = 0; i < APPENDED_LINES; ++i) {
+                std::string line = Bench::logLine(rng) + '\n';
+                std::fwrite(line.data(), 1, line.size(), file);
+            }
+
+            std::fflush(file);
+            lines = 0;
+        };
+
+        double rereadTime = Bench::measure([&]() {
+            append();
+            reread.read(count);
+
+            if (lines != APPENDED_LINES) {
+                std::fprintf(stderr, "getline read %lld lines instead of %d\n", lines, APPENDED_LINES);
+                std::exit(1);
+            }
+        });
+
+        tail.read(count);
+
+        double tailTime = Bench::measure([&]() {
+            append();
+            tail.read(count);
+
+            if (lines != APPENDED_LINES) {
+                std::fprintf(stderr, "LT::Tail read %lld lines instead of %d\n", lines, APPENDED_LINES);
+                std::exit(1);
+            }
+        });
+
+        std::fclose(file);
+
+        std::printf("%7lld MB %16.3f %16.4f %9.0fx\n", megabytes, rereadTime * 1000, tailTime * 1000, rereadTime / tailTime);
+    }
+
+    std::remove(filePath.c_str());
+}
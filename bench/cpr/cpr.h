@@ -0,0 +1,251 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// The part of cpr's API the overlay uses, on top of libcurl, for building the HTTP benchmark
+// where cpr isn't installed. Like cpr, a Session is one curl handle, so it keeps its connection
+// alive between requests. The CA bundle can be set with the CURL_CA_BUNDLE environment variable
+
+#pragma once
+
+#include <curl/curl.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <strings.h>
+#include <utility>
+#include <vector>
+
+#ifndef CPR_SHIM_H
+#define CPR_SHIM_H
+
+namespace cpr {
+
+    struct Url {
+        std::string url;
+
+        Url() {}
+        Url(std::string text) : url(std::move(text)) {}
+        Url(const char *text) : url(text) {}
+
+        const std::string &str() const {
+            return url;
+        }
+    };
+
+    struct Parameter {
+        std::string key, value;
+    };
+
+    struct Parameters {
+        std::vector<Parameter> parameters;
+
+        Parameters() {}
+        Parameters(std::initializer_list<Parameter> list) : parameters(list) {}
+
+        void Add(const Parameter &parameter) {
+            parameters.push_back(parameter);
+        }
+    };
+
+    struct CaseInsensitiveCompare {
+        bool operator()(const std::string &a, const std::string &b) const {
+            return strcasecmp(a.c_str(), b.c_str()) < 0;
+        }
+    };
+
+    using Header = std::map<std::string, std::string, CaseInsensitiveCompare>;
+
+    struct Body {
+        std::string body;
+
+        Body(std::string text) : body(std::move(text)) {}
+    };
+
+    struct Timeout {
+        long ms;
+
+        Timeout(std::chrono::milliseconds duration) : ms(duration.count()) {}
+        Timeout(long milliseconds) : ms(milliseconds) {}
+    };
+
+    struct ConnectTimeout {
+        long ms;
+
+        ConnectTimeout(std::chrono::milliseconds duration) : ms(duration.count()) {}
+    };
+
+    struct Error {
+        int code = 0;
+        std::string message;
+    };
+
+    struct Response {
+        long status_code = 0;
+        std::string text;
+        Header header;
+        Url url;
+        double elapsed = 0;
+        Error error;
+    };
+
+    class Session {
+      public:
+        Session() {
+            static bool initialized = curl_global_init(CURL_GLOBAL_DEFAULT) == CURLE_OK;
+            (void)initialized;
+
+            handle = curl_easy_init();
+            curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+
+            if (const char *bundle = std::getenv("CURL_CA_BUNDLE")) {
+                curl_easy_setopt(handle, CURLOPT_CAINFO, bundle);
+            }
+        }
+
+        ~Session() {
+            curl_easy_cleanup(handle);
+        }
+
+        Session(const Session &) = delete;
+        Session &operator=(const Session &) = delete;
+
+        void SetUrl(const Url &newUrl) {
+            url = newUrl.str();
+        }
+
+        void SetParameters(const Parameters &newParameters) {
+            parameters = newParameters;
+        }
+
+        void SetHeader(const Header &header) {
+            curl_slist_free_all(headers);
+            headers = NULL;
+
+            for (const auto &field : header) {
+                headers = curl_slist_append(headers, (field.first + ": " + field.second).c_str());
+            }
+
+            curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
+        }
+
+        void SetBody(const Body &newBody) {
+            body = newBody.body;
+        }
+
+        void SetTimeout(const Timeout &timeout) {
+            curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, timeout.ms);
+        }
+
+        void SetConnectTimeout(const ConnectTimeout &timeout) {
+            curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, timeout.ms);
+        }
+
+        Response Get() {
+            curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+            return perform();
+        }
+
+        Response Post() {
+            curl_easy_setopt(handle, CURLOPT_POSTFIELDS, body.c_str());
+            curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE, (long)body.size());
+            return perform();
+        }
+
+      private:
+        CURL *handle;
+        curl_slist *headers = NULL;
+        std::string url, body;
+        Parameters parameters;
+
+        static std::size_t writeText(char *data, std::size_t size, std::size_t count, void *text) {
+            static_cast<std::string *>(text)->append(data, size * count);
+            return size * count;
+        }
+
+        static std::size_t writeHeader(char *data, std::size_t size, std::size_t count, void *header) {
+            std::string line(data, size * count);
+            std::size_t colon = line.find(':');
+
+            if (colon != std::string::npos) {
+                std::size_t start = line.find_first_not_of(' ', colon + 1), end = line.find_last_not_of("\r\n");
+                (*static_cast<Header *>(header))[line.substr(0, colon)] = start > end ? "" : line.substr(start, end - start + 1);
+            }
+
+            return size * count;
+        }
+
+        Response perform() {
+            std::string fullUrl = url;
+
+            for (std::size_t i = 0; i < parameters.parameters.size(); ++i) {
+                const Parameter &parameter = parameters.parameters[i];
+                char *key = curl_easy_escape(handle, parameter.key.c_str(), parameter.key.size()),
+                     *value = curl_easy_escape(handle, parameter.value.c_str(), parameter.value.size());
+
+                fullUrl += (i == 0 ? "?" : "&") + std::string(key) + "=" + value;
+
+                curl_free(key);
+                curl_free(value);
+            }
+
+            Response response;
+            response.url = fullUrl;
+
+            curl_easy_setopt(handle, CURLOPT_URL, fullUrl.c_str());
+            curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, writeText);
+            curl_easy_setopt(handle, CURLOPT_WRITEDATA, &response.text);
+            curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, writeHeader);
+            curl_easy_setopt(handle, CURLOPT_HEADERDATA, &response.header);
+
+            CURLcode code = curl_easy_perform(handle);
+
+            if (code != CURLE_OK) {
+                response.error.code = code;
+                response.error.message = curl_easy_strerror(code);
+                return response;
+            }
+
+            curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &response.status_code);
+            curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME, &response.elapsed);
+
+            return response;
+        }
+    };
+
+    // A request on its own thread and connection
+    inline std::future<Response> GetAsync(Url url) {
+        return std::async(std::launch::async, [url]() {
+            Session session;
+            session.SetUrl(url);
+            return session.Get();
+        });
+    }
+
+}  // namespace cpr
+
+#endif  // CPR_SHIM_H
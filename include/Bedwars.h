@@ -45,13 +45,20 @@ namespace BWI {
     } // XP
 
     struct info {
-        int FK = 0, FD = 0, W = 0, L = 0;
+        int FK = 0, FD = 0, W = 0, L = 0, BB = 0;
         float FKDR = 0, WLR = 0;
 
         void round2DP() {
             FKDR = std::floor(FKDR * 100) / 100.0;
             WLR = std::floor(WLR * 100) / 100.0;
         }
+
+        void updateRatios() {
+            FKDR = FK / (float)(FD == 0 ? 1 : FD);
+            WLR = W / (float)(L == 0 ? 1 : L);
+
+            round2DP();
+        }
     };
 
     struct BedWarsInfo {
@@ -155,6 +162,12 @@ namespace BWI {
 
             mode.WLR = mode.W / (float)(mode.L == 0 ? 1 : mode.L);
 
+            try {
+                mode.BB = stats.at(id + "_beds_broken_bedwars");
+
+            } catch (const JSON::json::out_of_range &e) {
+            }
+
             mode.round2DP();
         }
 
@@ -167,9 +180,46 @@ namespace BWI {
             overall.L = solos.L + doubles.L + threes.L + fours.L;
             overall.WLR = overall.W / (float)(overall.L == 0 ? 1 : overall.L);
 
+            overall.BB = solos.BB + doubles.BB + threes.BB + fours.BB;
+
             overall.round2DP();
         }
 
+        BWI::info &mode(const std::string &displayMode) {
+            if (displayMode == "bw_solos") {
+                return solos;
+
+            } else if (displayMode == "bw_doubles") {
+                return doubles;
+
+            } else if (displayMode == "bw_threes") {
+                return threes;
+
+            } else if (displayMode == "bw_fours") {
+                return fours;
+
+            } else {
+                return overall;
+            }
+        }
+
+        // Live update from the kill feed of the game being played (assumed to be the displayed mode)
+        // The next API fetch replaces it with the real numbers
+        void addDelta(const std::string &displayMode, int finalKills, int finalDeaths, int bedsBroken) {
+            BWI::info &current = mode(displayMode);
+
+            for (BWI::info *stats : {&current, &overall}) {
+                stats->FK += finalKills;
+                stats->FD += finalDeaths;
+                stats->BB += bedsBroken;
+                stats->updateRatios();
+
+                if (&current == &overall) {
+                    break;
+                }
+            }
+        }
+
         void updateStarAndSymbolColors() {
             int starHexColor = -1, symbolHexColor;
             int starHexColors[4];
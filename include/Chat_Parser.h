@@ -0,0 +1,841 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+#ifndef CHAT_PARSER_H
+#define CHAT_PARSER_H
+
+namespace CP {
+
+    namespace JSON = nlohmann;
+
+    // The chat events are described by rules loaded from a data file:
+    //   "{value=word} has joined ({digits:1-2}/{digits:1-2})!" -> player_joined
+    // All rules (after all line prefixes) are compiled into one DFA which classifies
+    // a line in a single pass. Only the rule that matched is walked again to read its captures
+
+    enum class Event {
+        NONE,
+        JOIN_MINI_SERVER,   // Sending you to mini...
+        LEAVE_MINI_SERVER,  // sent to a main lobby or limbo
+        PLAYER_JOINED,      // <name> has joined (x/y)!
+        PLAYER_QUIT,        // <name> has quit!
+        WHO_COMMAND,        // ONLINE: <name>, <name>, ...
+        API_NEW,            // Your new API key is <key>
+        CHAT_MESSAGE,       // [RANK] <name>: <message>
+        FINAL_KILL,         // <victim> was ... by <killer>(/<killer>'s Iron Golem). FINAL KILL!
+        BED_BREAK,          // BED DESTRUCTION > <team> Bed was ... by <name>!
+        IGNORE              // lines a later rule would misread (ex. "Tip: ..." as chat)
+    };
+
+    const std::vector<std::pair<std::string, Event>> EVENT_NAMES = {
+        {"join_mini_server", Event::JOIN_MINI_SERVER},
+        {"leave_mini_server", Event::LEAVE_MINI_SERVER},
+        {"player_joined", Event::PLAYER_JOINED},
+        {"player_quit", Event::PLAYER_QUIT},
+        {"who_command", Event::WHO_COMMAND},
+        {"api_new", Event::API_NEW},
+        {"chat_message", Event::CHAT_MESSAGE},
+        {"final_kill", Event::FINAL_KILL},
+        {"bed_break", Event::BED_BREAK},
+        {"ignore", Event::IGNORE}
+    };
+
+    struct ChatLine {
+        Event event = Event::NONE;
+        std::string_view value, other;  // captured fields (name/server/player list/key depending on the event)
+    };
+
+    const std::string DEFAULT_RULES = R"({
+    "lineFilter": "[CHAT] ",
+    "prefixes": [
+        "[{digits:2}:{digits:2}:{digits:2}] [Client thread/INFO]: [CHAT] "
+    ],
+    "rules": [
+        {"event": "join_mini_server", "pattern": "Sending you to mini{value=word}"},
+        {"event": "join_mini_server", "pattern": "       "},
+        {"event": "leave_mini_server", "pattern": "Sending you to {value=word}"},
+        {"event": "leave_mini_server", "pattern": "You were spawned in Limbo."},
+        {"event": "leave_mini_server", "pattern": "You are AFK. Move around to return from AFK."},
+        {"event": "player_joined", "pattern": "{value=word} has joined ({digits:1-2}/{digits:1-2})!"},
+        {"event": "player_quit", "pattern": "{value=word} has quit!"},
+        {"event": "who_command", "pattern": "ONLINE: {value=text}"},
+        {"event": "api_new", "pattern": "Your new API key is {value=text}"},
+        {"event": "ignore", "pattern": "From [{text}"},
+        {"event": "ignore", "pattern": "From {name}: {text}"},
+        {"event": "ignore", "pattern": "To [{text}"},
+        {"event": "ignore", "pattern": "To {name}: {text}"},
+        {"event": "ignore", "pattern": "Party > {text}"},
+        {"event": "ignore", "pattern": "Guild > {text}"},
+        {"event": "ignore", "pattern": "Officer > {text}"},
+        {"event": "final_kill", "pattern": "{value=name} {text} by {other=name}'s Iron Golem. FINAL KILL!"},
+        {"event": "final_kill", "pattern": "{value=name} {text} by {other=name}'s {word}. FINAL KILL!"},
+        {"event": "final_kill", "pattern": "{value=name} {text} by {other=name}. FINAL KILL!"},
+        {"event": "final_kill", "pattern": "{value=name} {text}. FINAL KILL!"},
+        {"event": "bed_break", "pattern": "BED DESTRUCTION > {text} by {value=name}!"},
+        {"event": "ignore", "pattern": "Tip: {text}"},
+        {"event": "ignore", "pattern": "Party: {text}"},
+        {"event": "ignore", "pattern": "Guild: {text}"},
+        {"event": "ignore", "pattern": "Friend: {text}"},
+        {"event": "ignore", "pattern": "Note: {text}"},
+        {"event": "ignore", "pattern": "Warning: {text}"},
+        {"event": "ignore", "pattern": "Error: {text}"},
+        {"event": "ignore", "pattern": "Reward: {text}"},
+        {"event": "ignore", "pattern": "Map: {text}"},
+        {"event": "ignore", "pattern": "Mode: {text}"},
+        {"event": "ignore", "pattern": "Team: {text}"},
+        {"event": "chat_message", "pattern": "[{name}] {value=name:3-16}: {text}"},
+        {"event": "chat_message", "pattern": "[{name}+] {value=name:3-16}: {text}"},
+        {"event": "chat_message", "pattern": "[{name}++] {value=name:3-16}: {text}"},
+        {"event": "chat_message", "pattern": "{value=name:3-16}: {text}"},
+        {"event": "leave_mini_server", "pattern": "{text} joined the lobby!"},
+        {"event": "leave_mini_server", "pattern": " >>> {text} joined the lobby! <<<"}
+    ]
+})";
+
+    const std::string RULES_INFORMATION = R"(
+
+// lineFilter: only lines containing this text are classified (empty to classify every line)
+// prefixes: patterns every chat line starts with (one per client log format)
+// rules: checked in order, the first one matching the whole rest of the line wins
+//   event: join_mini_server/leave_mini_server/player_joined/player_quit/who_command/api_new/chat_message/final_kill/bed_break,
+//          or ignore for lines that a rule after it would match by mistake (ex. "Tip: ..." as a chat message)
+//   pattern: literal text with placeholders
+//     {word}: non-whitespace characters, {name}: A-Z a-z 0-9 _, {digits}: 0-9
+//     {text}: anything (at the end, or once in the middle if every placeholder after it is preceded by a character it can't match)
+//     {digits:2} exactly 2, {digits:1-2} 1 to 2, {word:3-} at least 3
+//     {value=word} captures the placeholder into the event's value ({other=...} for a second field)
+//     {{ for a literal {
+)";
+
+    inline bool isDigit(char c) {
+        return '0' <= c && c <= '9';
+    }
+
+    // same set of characters as \s
+    inline bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+
+    // same set of characters as . (anything but a line terminator)
+    inline bool isSingleLine(std::string_view text) {
+        return std::memchr(text.data(), '\r', text.size()) == NULL && std::memchr(text.data(), '\n', text.size()) == NULL;
+    }
+
+    // Compact chat mods append " [x2]" or " (2)" to repeated lines
+    inline std::string_view stripCompactChat(std::string_view line) {
+        std::size_t separator = line.rfind(' ');
+
+        if (separator == std::string_view::npos || separator == 0 || line.size() - separator < 4) {
+            return line;
+        }
+
+        std::string_view suffix = line.substr(separator + 1);
+        std::size_t digitsStart;
+
+        if (suffix.front() == '[' && suffix[1] == 'x' && suffix.back() == ']') {
+            digitsStart = 2;
+
+        } else if (suffix.front() == '(' && suffix.back() == ')') {
+            digitsStart = 1;
+
+        } else {
+            return line;
+        }
+
+        if (digitsStart + 1 >= suffix.size()) {
+            return line;
+        }
+
+        for (std::size_t i = digitsStart; i < suffix.size() - 1; ++i) {
+            if (!isDigit(suffix[i])) {
+                return line;
+            }
+        }
+
+        if (!isSingleLine(line.substr(0, separator))) {
+            return line;
+        }
+
+        return line.substr(0, separator);
+    }
+
+    namespace Pattern {
+
+        enum class Kind {
+            LITERAL,
+            WORD,
+            NAME,
+            DIGITS,
+            TEXT
+        };
+
+        const int UNBOUNDED = -1;
+
+        struct Token {
+            Kind kind = Kind::LITERAL;
+            char literal = 0;
+            int min = 1, max = 1;
+            int field = -1;  // -1 = not captured, 0 = value, 1 = other
+            std::bitset<256> characters;
+
+            bool fixedLength() const {
+                return min == max;
+            }
+        };
+
+        inline std::bitset<256> characterSet(Kind kind, char literal) {
+            std::bitset<256> characters;
+
+            for (int c = 0; c < 256; ++c) {
+                switch (kind) {
+                    case Kind::LITERAL:
+                        characters[c] = c == (unsigned char)literal;
+                        break;
+
+                    case Kind::WORD:
+                        characters[c] = !isSpace((char)c);
+                        break;
+
+                    case Kind::NAME:
+                        characters[c] = isDigit((char)c) || ('A' <= c && c <= 'Z') || ('a' <= c && c <= 'z') || c == '_';
+                        break;
+
+                    case Kind::DIGITS:
+                        characters[c] = isDigit((char)c);
+                        break;
+
+                    case Kind::TEXT:
+                        characters[c] = c != '\r' && c != '\n';
+                        break;
+                }
+            }
+
+            return characters;
+        }
+
+        // {[field=]kind[:min[-[max]]]}
+        inline Token parsePlaceholder(const std::string &placeholder) {
+            Token token;
+            std::string kind = placeholder;
+
+            std::size_t equals = kind.find('=');
+
+            if (equals != std::string::npos) {
+                std::string field = kind.substr(0, equals);
+                kind.erase(0, equals + 1);
+
+                if (field == "value") {
+                    token.field = 0;
+
+                } else if (field == "other") {
+                    token.field = 1;
+
+                } else {
+                    throw std::invalid_argument("unknown field \"" + field + "\"");
+                }
+            }
+
+            std::string counts;
+            std::size_t colon = kind.find(':');
+
+            if (colon != std::string::npos) {
+                counts = kind.substr(colon + 1);
+                kind.erase(colon);
+            }
+
+            if (kind == "word") {
+                token.kind = Kind::WORD;
+
+            } else if (kind == "name") {
+                token.kind = Kind::NAME;
+
+            } else if (kind == "digits") {
+                token.kind = Kind::DIGITS;
+
+            } else if (kind == "text") {
+                token.kind = Kind::TEXT;
+
+            } else {
+                throw std::invalid_argument("unknown placeholder \"" + kind + "\"");
+            }
+
+            token.min = 1;
+            token.max = UNBOUNDED;
+
+            if (counts.size() > 0) {
+                std::size_t dash = counts.find('-');
+
+                try {
+                    token.min = std::stoi(counts.substr(0, dash));
+
+                    if (dash == std::string::npos) {
+                        token.max = token.min;
+
+                    } else if (dash + 1 < counts.size()) {
+                        token.max = std::stoi(counts.substr(dash + 1));
+                    }
+
+                } catch (const std::logic_error &e) {
+                    throw std::invalid_argument("invalid count \"" + counts + "\"");
+                }
+
+                if (token.min < 1 || (token.max != UNBOUNDED && token.max < token.min)) {
+                    throw std::invalid_argument("invalid count \"" + counts + "\"");
+                }
+            }
+
+            token.characters = characterSet(token.kind, 0);
+
+            return token;
+        }
+
+        inline std::vector<Token> parse(const std::string &pattern) {
+            std::vector<Token> tokens;
+
+            for (std::size_t i = 0; i < pattern.size(); ++i) {
+                if (pattern[i] == '{' && (i + 1 >= pattern.size() || pattern[i + 1] != '{')) {
+                    std::size_t end = pattern.find('}', i);
+
+                    if (end == std::string::npos) {
+                        throw std::invalid_argument("unterminated placeholder");
+                    }
+
+                    tokens.push_back(parsePlaceholder(pattern.substr(i + 1, end - i - 1)));
+                    i = end;
+
+                } else {
+                    if (pattern[i] == '{') {
+                        ++i;  // {{
+                    }
+
+                    Token token;
+                    token.literal = pattern[i];
+                    token.characters = characterSet(Kind::LITERAL, pattern[i]);
+                    tokens.push_back(token);
+                }
+            }
+
+            return tokens;
+        }
+
+        // Index of a {text} placeholder that isn't last (tokens.size() if there's none)
+        inline std::size_t middleText(const std::vector<Token> &tokens) {
+            for (std::size_t i = 0; i + 1 < tokens.size(); ++i) {
+                if (tokens[i].kind == Kind::TEXT) {
+                    return i;
+                }
+            }
+
+            return tokens.size();
+        }
+
+        // Captures are read with a greedy walk after the DFA matched, which is only exact if
+        // every variable length placeholder is followed by a character it can't contain (or is last)
+        // One {text} may sit in the middle, everything after it is walked back from the end of the line
+        // instead, so there every variable length placeholder has to be preceded by a character it can't contain
+        inline void validate(const std::vector<Token> &tokens) {
+            std::size_t middle = middleText(tokens);
+
+            for (std::size_t i = 0; i < middle && i + 1 < tokens.size(); ++i) {
+                if (tokens[i].fixedLength()) {
+                    continue;
+                }
+
+                const Token &next = tokens[i + 1];
+
+                if (next.kind != Kind::LITERAL || tokens[i].characters[(unsigned char)next.literal]) {
+                    throw std::invalid_argument("variable length placeholder must be last or followed by a character it can't match");
+                }
+            }
+
+            for (std::size_t i = tokens.size(); i-- > middle + 1;) {
+                if (tokens[i].fixedLength()) {
+                    continue;
+                }
+
+                const Token &previous = tokens[i - 1];
+
+                if (previous.kind != Kind::LITERAL || tokens[i].characters[(unsigned char)previous.literal]) {
+                    throw std::invalid_argument("variable length placeholder after {text} must be preceded by a character it can't match");
+                }
+            }
+        }
+
+    }  // namespace Pattern
+
+    struct Rule {
+        Event event = Event::NONE;
+        std::string pattern;
+        std::vector<Pattern::Token> tokens;
+    };
+
+    // Combined automaton for every (prefix, rule) pair
+    struct Automaton {
+        std::string lineFilter;
+        std::vector<std::vector<Pattern::Token>> prefixes;
+        std::vector<Rule> rules;
+
+        // DFA over byte classes (bytes that no pattern tells apart share a class)
+        unsigned char byteClass[256] = {};
+        int classCount = 0;
+        std::vector<int> transitions;  // state * classCount + class -> state (-1 = no match)
+        std::vector<int> accepting;    // state -> rule * prefixes.size() + prefix (-1 = not accepting)
+
+        bool empty() const {
+            return accepting.empty();
+        }
+
+        struct NfaState {
+            std::bitset<256> on;
+            int next = -1;
+            std::vector<int> epsilon;
+            int accept = -1;
+        };
+
+        static int addState(std::vector<NfaState> &nfa) {
+            nfa.emplace_back();
+            return nfa.size() - 1;
+        }
+
+        static int addTransition(std::vector<NfaState> &nfa, int from, const std::bitset<256> &characters) {
+            int to = addState(nfa);
+            nfa[from].on = characters;
+            nfa[from].next = to;
+            return to;
+        }
+
+        static int addTokens(std::vector<NfaState> &nfa, int current, const std::vector<Pattern::Token> &tokens) {
+            for (const Pattern::Token &token : tokens) {
+                for (int i = 0; i < token.min; ++i) {
+                    current = addTransition(nfa, current, token.characters);
+                }
+
+                if (token.max == Pattern::UNBOUNDED) {
+                    int exit = addState(nfa);
+                    nfa[current].on = token.characters;
+                    nfa[current].next = current;
+                    nfa[current].epsilon.push_back(exit);
+                    current = exit;
+
+                } else {
+                    std::vector<int> skips;
+
+                    for (int i = token.min; i < token.max; ++i) {
+                        skips.push_back(current);
+                        current = addTransition(nfa, current, token.characters);
+                    }
+
+                    for (int skip : skips) {
+                        nfa[skip].epsilon.push_back(current);
+                    }
+                }
+            }
+
+            return current;
+        }
+
+        static void closure(const std::vector<NfaState> &nfa, std::vector<int> &states) {
+            std::vector<bool> seen(nfa.size(), false);
+            std::vector<int> stack(states);
+
+            for (int state : states) {
+                seen[state] = true;
+            }
+
+            while (!stack.empty()) {
+                int state = stack.back();
+                stack.pop_back();
+
+                for (int next : nfa[state].epsilon) {
+                    if (!seen[next]) {
+                        seen[next] = true;
+                        states.push_back(next);
+                        stack.push_back(next);
+                    }
+                }
+            }
+
+            std::sort(states.begin(), states.end());
+        }
+
+        void compile() {
+            std::vector<NfaState> nfa;
+            int start = addState(nfa);
+
+            for (std::size_t r = 0; r < rules.size(); ++r) {
+                for (std::size_t p = 0; p < prefixes.size(); ++p) {
+                    int branch = addState(nfa);
+                    nfa[start].epsilon.push_back(branch);
+
+                    int end = addTokens(nfa, addTokens(nfa, branch, prefixes[p]), rules[r].tokens);
+                    nfa[end].accept = r * prefixes.size() + p;
+                }
+            }
+
+            // split the bytes into classes
+            {
+                std::map<std::vector<bool>, int> signatures;
+
+                for (int c = 0; c < 256; ++c) {
+                    std::vector<bool> signature;
+
+                    for (const NfaState &state : nfa) {
+                        if (state.next != -1) {
+                            signature.push_back(state.on[c]);
+                        }
+                    }
+
+                    auto inserted = signatures.insert({signature, (int)signatures.size()});
+                    byteClass[c] = inserted.first->second;
+                }
+
+                classCount = signatures.size();
+            }
+
+            // subset construction
+            std::map<std::vector<int>, int> dfaStates;
+            std::vector<std::vector<int>> queue;
+
+            auto getState = [&](std::vector<int> states) {
+                closure(nfa, states);
+
+                auto found = dfaStates.find(states);
+
+                if (found != dfaStates.end()) {
+                    return found->second;
+                }
+
+                int id = queue.size();
+                int accept = -1;
+
+                for (int state : states) {
+                    if (nfa[state].accept != -1 && (accept == -1 || nfa[state].accept < accept)) {
+                        accept = nfa[state].accept;
+                    }
+                }
+
+                dfaStates.insert({states, id});
+                queue.push_back(states);
+                accepting.push_back(accept);
+                transitions.resize(transitions.size() + classCount, -1);
+
+                return id;
+            };
+
+            transitions.clear();
+            accepting.clear();
+
+            getState({start});
+
+            // representative byte of each class
+            std::vector<int> representative(classCount);
+
+            for (int c = 255; c >= 0; --c) {
+                representative[byteClass[c]] = c;
+            }
+
+            for (std::size_t id = 0; id < queue.size(); ++id) {
+                for (int cls = 0; cls < classCount; ++cls) {
+                    std::vector<int> next;
+
+                    for (int state : queue[id]) {
+                        if (nfa[state].next != -1 && nfa[state].on[representative[cls]]) {
+                            next.push_back(nfa[state].next);
+                        }
+                    }
+
+                    if (next.size() > 0) {
+                        std::sort(next.begin(), next.end());
+                        next.erase(std::unique(next.begin(), next.end()), next.end());
+
+                        int nextState = getState(next);
+                        transitions[id * classCount + cls] = nextState;
+                    }
+                }
+            }
+
+            spdlog::info("Compiled {} chat rules ({} prefixes) into {} DFA states, {} byte classes", rules.size(), prefixes.size(), queue.size(), classCount);
+        }
+
+        static void capture(const Pattern::Token &token, std::string_view text, ChatLine &chatLine) {
+            if (token.field == 0) {
+                chatLine.value = text;
+
+            } else if (token.field == 1) {
+                chatLine.other = text;
+            }
+        }
+
+        // Read the captures of the (prefix, rule) pair that matched the line
+        void extract(std::string_view line, const std::vector<Pattern::Token> &tokens, std::size_t &position, ChatLine &chatLine) const {
+            std::size_t middle = Pattern::middleText(tokens);
+
+            for (std::size_t i = 0; i < middle; ++i) {
+                const Pattern::Token &token = tokens[i];
+                std::size_t start = position;
+
+                if (token.kind == Pattern::Kind::LITERAL || token.fixedLength()) {
+                    position += token.min;
+
+                } else {
+                    while (position < line.size() && (token.max == Pattern::UNBOUNDED || (int)(position - start) < token.max) &&
+                            token.characters[(unsigned char)line[position]]) {
+                        ++position;
+                    }
+                }
+
+                capture(token, line.substr(start, position - start), chatLine);
+            }
+
+            if (middle == tokens.size()) {
+                return;
+            }
+
+            // the rest of the rule ends with the line, walk it backwards up to the {text}
+            std::size_t end = line.size();
+
+            for (std::size_t i = tokens.size(); i-- > middle + 1;) {
+                const Pattern::Token &token = tokens[i];
+                std::size_t tokenEnd = end;
+
+                if (token.kind == Pattern::Kind::LITERAL || token.fixedLength()) {
+                    end -= token.min;
+
+                } else {
+                    while (end > position && (token.max == Pattern::UNBOUNDED || (int)(tokenEnd - end) < token.max) &&
+                            token.characters[(unsigned char)line[end - 1]]) {
+                        --end;
+                    }
+                }
+
+                capture(token, line.substr(end, tokenEnd - end), chatLine);
+            }
+
+            capture(tokens[middle], line.substr(position, end - position), chatLine);
+            position = line.size();
+        }
+
+        ChatLine classify(std::string_view line) const {
+            ChatLine chatLine;
+
+            if (empty()) {
+                return chatLine;
+            }
+
+            int state = 0;
+
+            for (char c : line) {
+                state = transitions[state * classCount + byteClass[(unsigned char)c]];
+
+                if (state == -1) {
+                    return chatLine;
+                }
+            }
+
+            int accept = accepting[state];
+
+            if (accept == -1) {
+                return chatLine;
+            }
+
+            const Rule &rule = rules[accept / prefixes.size()];
+            std::size_t position = 0;
+
+            extract(line, prefixes[accept % prefixes.size()], position, chatLine);
+            extract(line, rule.tokens, position, chatLine);
+            chatLine.event = rule.event;
+
+            return chatLine;
+        }
+    };
+
+    Automaton automaton;
+
+    std::string rulesFilePath = "./assets/chat_rules.json";
+
+    inline Event eventFromString(const std::string &name) {
+        for (const auto &event : EVENT_NAMES) {
+            if (event.first == name) {
+                return event.second;
+            }
+        }
+
+        return Event::NONE;
+    }
+
+    // Compile the rules from JSON data. Invalid prefixes/rules are skipped
+    inline Automaton compile(const JSON::json &data) {
+        Automaton compiled;
+
+        try {
+            compiled.lineFilter = data.at("lineFilter");
+
+        } catch (const JSON::json::exception &e) {
+            spdlog::warn("Could not load lineFilter from chat rules");
+        }
+
+        try {
+            for (const std::string prefix : data.at("prefixes")) {
+                try {
+                    std::vector<Pattern::Token> tokens = Pattern::parse(prefix);
+                    Pattern::validate(tokens);
+
+                    // so the placeholders of the rule after it can't be mistaken for part of the prefix
+                    if (tokens.empty() || tokens.back().kind != Pattern::Kind::LITERAL) {
+                        throw std::invalid_argument("prefix must end with literal text");
+                    }
+
+                    if (Pattern::middleText(tokens) != tokens.size()) {
+                        throw std::invalid_argument("prefix can't contain {text}");
+                    }
+
+                    compiled.prefixes.push_back(tokens);
+
+                } catch (const std::invalid_argument &e) {
+                    spdlog::error("Invalid chat rule prefix \"{}\": {}", prefix, e.what());
+                }
+            }
+
+        } catch (const JSON::json::exception &e) {
+            spdlog::error("Could not load prefixes from chat rules");
+        }
+
+        try {
+            for (const JSON::json &ruleData : data.at("rules")) {
+                Rule rule;
+
+                try {
+                    std::string eventName = ruleData.at("event");
+                    rule.pattern = ruleData.at("pattern");
+                    rule.event = eventFromString(eventName);
+
+                    if (rule.event == Event::NONE) {
+                        spdlog::error("Unknown chat rule event \"{}\"", eventName);
+                        continue;
+                    }
+
+                    rule.tokens = Pattern::parse(rule.pattern);
+                    Pattern::validate(rule.tokens);
+
+                    compiled.rules.push_back(rule);
+
+                } catch (const JSON::json::exception &e) {
+                    spdlog::error("Invalid chat rule {}: {}", ruleData.dump(), e.what());
+
+                } catch (const std::invalid_argument &e) {
+                    spdlog::error("Invalid chat rule pattern \"{}\": {}", rule.pattern, e.what());
+                }
+            }
+
+        } catch (const JSON::json::exception &e) {
+            spdlog::error("Could not load rules from chat rules");
+        }
+
+        if (compiled.prefixes.size() > 0 && compiled.rules.size() > 0) {
+            compiled.compile();
+        }
+
+        return compiled;
+    }
+
+    // Load the chat rules from the data file (written with the defaults if it doesn't exist)
+    void load() {
+        spdlog::info("Attempting to load chat rules from {}", rulesFilePath);
+
+        std::ifstream fileStream(rulesFilePath, std::ios::binary);
+
+        if (!fileStream) {
+            spdlog::info("No chat rules file. Writing the default rules");
+
+            std::ofstream outputStream(rulesFilePath, std::ios::binary);
+            outputStream << DEFAULT_RULES << RULES_INFORMATION;
+
+            automaton = compile(JSON::json::parse(DEFAULT_RULES));
+            return;
+        }
+
+        std::stringstream buffer;
+        buffer << fileStream.rdbuf();
+
+        try {
+            automaton = compile(JSON::json::parse(buffer.str(),
+                                                  /*callback*/ nullptr,
+                                                  /*allow exceptions*/ true,
+                                                  /*allow comments*/ true));
+
+        } catch (const JSON::json::parse_error &e) {
+            spdlog::error("Could not load chat rules file (using the default rules):\n{}", e.what());
+        }
+
+        if (automaton.empty()) {
+            automaton = compile(JSON::json::parse(DEFAULT_RULES));
+        }
+    }
+
+    inline ChatLine classify(std::string_view line) {
+        return automaton.classify(stripCompactChat(line));
+    }
+
+    // Calls callback(std::string_view name) for every name in a /who list ("a, b, c")
+    // Names are trimmed of spaces. Like std::getline, a trailing empty entry is skipped
+    template <typename Callback>
+    void forEachName(std::string_view list, Callback callback) {
+        while (!list.empty()) {
+            std::size_t separator = list.find(',');
+            std::string_view name = list.substr(0, separator);
+
+            list = separator == std::string_view::npos ? std::string_view() : list.substr(separator + 1);
+
+            while (!name.empty() && name.front() == ' ') {
+                name.remove_prefix(1);
+            }
+
+            while (!name.empty() && name.back() == ' ') {
+                name.remove_suffix(1);
+            }
+
+            callback(name);
+        }
+    }
+
+}  // namespace CP
+
+#endif  // CHAT_PARSER_H
@@ -34,6 +34,7 @@ SOFTWARE.
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 
 #ifndef FILE_LOADER_H
@@ -54,15 +55,21 @@ namespace FL {
               "// opacity: opacity of overlay (%)\n"
               "// backgroundHexColor: background color (hex)"
               "// scale: text scale (%)\n"
-              "// fileDelay: time before parsing log file again (ms)\n"
+              "// fileDelay: time before parsing log file again if file change notifications are unavailable (ms)\n"
+              "// watchTimeout: maximum time to wait for a log file change notification before parsing it anyway (ms)\n"
               "// cachePlayerTime: time before removing player from cache (s)\n"
+              "// maxRequests: maximum number of API requests in flight at once\n"
+              "// uuidTimeout/profileTimeout/skinTimeout/dataTimeout: deadline of the UUID, skin URL, skin and Hypixel stats requests (ms, 0 for none)\n"
+              "// renderHeads: render player heads, their skins aren't downloaded at all when off (true/false)\n"
               "// renderHeadOverlay: render extra head/face details (true/false)\n"
               "// fakeFullscreen: fake fullscreen support (true/false)\n"
-              "// apiKey: Hypixel API key (/api new)\n"
+              "// discoverFromChat: start fetching players who chat in the pre-game lobby before they show up in the table (true/false)\n"
+              "// hedgeRequests: send a request again if it takes longer than usual and use whichever answer comes first (true/false)\n"
+              "// apiKey: Hypixel API key (/api new) (or a list of keys to spread the requests over)\n"
               "// displayMode: mode to display (bw_solos/bw_doubles/bw_threes/bw_fours/bw_overall/miniwalls)\n"
               "// titleFontPath: location of font for the title bar\n"
               "// statsFontPath: location of font for the player stats\n"
-              "// minecraftLogPath: location of Minecraft's log path\n";
+              "// minecraftLogPath: location of Minecraft's log path (or a list of paths to follow several clients at once)\n";
         ss << "//   Examples:\n";
         ss << "//   Vanilla - " << appdataEnvPath << "/AppData/Roaming/.minecraft/logs/latest.log\n";
         ss << "//   Lunar - " << appdataEnvPath << "/.lunarclient/offline/1.8/logs/latest.log\n";
@@ -88,11 +95,14 @@ namespace FL {
     }
 
     struct Data {
-        int screenWidth = 800, opacity = 70, scale = 100, fileDelay = 100, cachePlayerTime = 4 * 60;
-        bool renderHeadOverlay = true, fakeFullscreen = true;
+        int screenWidth = 800, opacity = 70, scale = 100, fileDelay = 100, watchTimeout = 1000, cachePlayerTime = 4 * 60, maxRequests = 8,
+            uuidTimeout = 5000, profileTimeout = 5000, skinTimeout = 5000, dataTimeout = 5000;
+        bool renderHeads = true, renderHeadOverlay = true, fakeFullscreen = true, discoverFromChat = false, hedgeRequests = true;
         SDL_Color backgroundColor = {50, 50, 50, 255};
-        std::string apiKey = "YOUR-HYPIXEL-API-KEY-HERE", displayMode = "bw_overall", minecraftLogPath = "C:/Users/YourName/AppData/Roaming/.minecraft/logs/latest.log",
+        std::string displayMode = "bw_overall",
                     titleFontPath = "./assets/SourceCodePro.ttf", statsFontPath = "./assets/SourceCodePro.ttf";
+        std::vector<std::string> apiKeys = {"YOUR-HYPIXEL-API-KEY-HERE"};
+        std::vector<std::string> minecraftLogPaths = {"C:/Users/YourName/AppData/Roaming/.minecraft/logs/latest.log"};
         Mode mode = Mode::BEDWARS;
     };
 
@@ -102,7 +112,8 @@ namespace FL {
 
     std::string information = buildInformationString();
 
-    Data load() {
+    // testApiKeys=false keeps every API key without asking Hypixel (for runs that don't fetch anything)
+    Data load(bool testApiKeys = true) {
         spdlog::info("Attempting to load config data");
         config = {};
 
@@ -201,6 +212,21 @@ namespace FL {
                 spdlog::warn("Could not load fileDelay");
             }
 
+            try {
+                int watchTimeout = data.at("watchTimeout");
+
+                if (watchTimeout >= 0) {
+                    config.watchTimeout = watchTimeout;
+                    spdlog::info("Set watchTimeout={}", config.watchTimeout);
+
+                } else {
+                    spdlog::info("Invalid watchTimeout");
+                }
+
+            } catch (const JSON::json::out_of_range &e) {
+                spdlog::warn("Could not load watchTimeout");
+            }
+
             try {
                 int cachePlayerTime = data.at("cachePlayerTime");
 
@@ -216,6 +242,101 @@ namespace FL {
                 spdlog::warn("Could not load cachePlayerTime");
             }
 
+            try {
+                int maxRequests = data.at("maxRequests");
+
+                if (maxRequests > 0) {
+                    config.maxRequests = maxRequests;
+                    spdlog::info("Set maxRequests={}", config.maxRequests);
+
+                } else {
+                    spdlog::info("Invalid maxRequests");
+                }
+
+            } catch (const JSON::json::out_of_range &e) {
+                spdlog::warn("Could not load maxRequests");
+            }
+
+            try {
+                int uuidTimeout = data.at("uuidTimeout");
+
+                if (uuidTimeout >= 0) {
+                    config.uuidTimeout = uuidTimeout;
+                    spdlog::info("Set uuidTimeout={}", config.uuidTimeout);
+
+                } else {
+                    spdlog::info("Invalid uuidTimeout");
+                }
+
+            } catch (const JSON::json::out_of_range &e) {
+                spdlog::warn("Could not load uuidTimeout");
+            }
+
+            try {
+                int profileTimeout = data.at("profileTimeout");
+
+                if (profileTimeout >= 0) {
+                    config.profileTimeout = profileTimeout;
+                    spdlog::info("Set profileTimeout={}", config.profileTimeout);
+
+                } else {
+                    spdlog::info("Invalid profileTimeout");
+                }
+
+            } catch (const JSON::json::out_of_range &e) {
+                spdlog::warn("Could not load profileTimeout");
+            }
+
+            try {
+                int skinTimeout = data.at("skinTimeout");
+
+                if (skinTimeout >= 0) {
+                    config.skinTimeout = skinTimeout;
+                    spdlog::info("Set skinTimeout={}", config.skinTimeout);
+
+                } else {
+                    spdlog::info("Invalid skinTimeout");
+                }
+
+            } catch (const JSON::json::out_of_range &e) {
+                spdlog::warn("Could not load skinTimeout");
+            }
+
+            try {
+                int dataTimeout = data.at("dataTimeout");
+
+                if (dataTimeout >= 0) {
+                    config.dataTimeout = dataTimeout;
+                    spdlog::info("Set dataTimeout={}", config.dataTimeout);
+
+                } else {
+                    spdlog::info("Invalid dataTimeout");
+                }
+
+            } catch (const JSON::json::out_of_range &e) {
+                spdlog::warn("Could not load dataTimeout");
+            }
+
+            try {
+                std::string renderHeads = data.at("renderHeads");
+
+                std::transform(renderHeads.begin(), renderHeads.end(), renderHeads.begin(), [](char &c) {
+                    return std::tolower(c);
+                });
+
+                if (renderHeads == "0" || renderHeads == "f" || renderHeads == "false" || renderHeads == "n" || renderHeads == "no") {
+                    config.renderHeads = false;
+
+                } else {
+                    config.renderHeads = true;
+                }
+
+                spdlog::info("Set renderHeads={}", config.renderHeads);
+
+            } catch (const JSON::json::out_of_range &e) {
+                spdlog::warn("Could not load renderHeads");
+            }
+
             try {
                 std::string renderHeadOverlay = data.at("renderHeadOverlay");
 
@@ -257,17 +378,74 @@ namespace FL {
             }
 
             try {
-                std::string apiKey = data.at("apiKey");
+                std::string discoverFromChat = data.at("discoverFromChat");
+
+                std::transform(discoverFromChat.begin(), discoverFromChat.end(), discoverFromChat.begin(), [](char &c) {
+                    return std::tolower(c);
+                });
+
+                if (discoverFromChat == "0" || discoverFromChat == "f" || discoverFromChat == "false" || discoverFromChat == "n" || discoverFromChat == "no") {
+                    config.discoverFromChat = false;
+
+                } else {
+                    config.discoverFromChat = true;
+                }
+
+                spdlog::info("Set discoverFromChat={}", config.discoverFromChat);
+
+            } catch (const JSON::json::out_of_range &e) {
+                spdlog::warn("Could not load discoverFromChat");
+            }
+
+            try {
+                std::string hedgeRequests = data.at("hedgeRequests");
 
-                if (apiKey.size() > 0 && apiKey != config.apiKey && MPI::testApiKey(apiKey)) {
-                    config.apiKey = apiKey;
-                    spdlog::info("Set apiKey={}", config.apiKey);
+                std::transform(hedgeRequests.begin(), hedgeRequests.end(), hedgeRequests.begin(), [](char &c) {
+                    return std::tolower(c);
+                });
+
+                if (hedgeRequests == "0" || hedgeRequests == "f" || hedgeRequests == "false" || hedgeRequests == "n" || hedgeRequests == "no") {
+                    config.hedgeRequests = false;
 
                 } else {
-                    spdlog::error("Invalid apiKey");
+                    config.hedgeRequests = true;
                 }
 
+                spdlog::info("Set hedgeRequests={}", config.hedgeRequests);
+
             } catch (const JSON::json::out_of_range &e) {
+                spdlog::warn("Could not load hedgeRequests");
+            }
+
+            try {
+                JSON::json apiKeyData = data.at("apiKey");
+                std::vector<std::string> apiKeys;
+
+                if (apiKeyData.is_array()) {
+                    apiKeys = apiKeyData.get<std::vector<std::string>>();
+
+                } else {
+                    apiKeys.push_back(apiKeyData);
+                }
+
+                std::vector<std::string> validApiKeys;
+
+                for (const std::string &apiKey : apiKeys) {
+                    if (apiKey.size() > 0 && apiKey != Data().apiKeys.front() &&
+                            std::find(validApiKeys.begin(), validApiKeys.end(), apiKey) == validApiKeys.end() && (!testApiKeys || MPI::testApiKey(apiKey))) {
+                        validApiKeys.push_back(apiKey);
+                        spdlog::info("Set apiKey={}", apiKey);
+
+                    } else {
+                        spdlog::error("Invalid apiKey={}", apiKey);
+                    }
+                }
+
+                if (validApiKeys.size() > 0) {
+                    config.apiKeys = validApiKeys;
+                }
+
+            } catch (const JSON::json::exception &e) {
                 spdlog::error("Invalid apiKey");
             }
 
@@ -298,19 +476,36 @@ namespace FL {
             }
 
             try {
-                std::string minecraftLogPath = data.at("minecraftLogPath");
-
-                std::ifstream logFile(minecraftLogPath);
+                // a single path or a list of paths (one per running client)
+                JSON::json minecraftLogPathData = data.at("minecraftLogPath");
+                std::vector<std::string> minecraftLogPaths;
 
-                if (logFile.good()) {
-                    config.minecraftLogPath = minecraftLogPath;
-                    spdlog::info("Set minecraftLogPath={}", config.minecraftLogPath);
+                if (minecraftLogPathData.is_array()) {
+                    minecraftLogPaths = minecraftLogPathData.get<std::vector<std::string>>();
 
                 } else {
-                    spdlog::error("Invalid minecraftLogPath");
+                    minecraftLogPaths.push_back(minecraftLogPathData);
                 }
 
-            } catch (const JSON::json::out_of_range &e) {
+                std::vector<std::string> validLogPaths;
+
+                for (const std::string &minecraftLogPath : minecraftLogPaths) {
+                    std::ifstream logFile(minecraftLogPath);
+
+                    if (logFile.good() && std::find(validLogPaths.begin(), validLogPaths.end(), minecraftLogPath) == validLogPaths.end()) {
+                        validLogPaths.push_back(minecraftLogPath);
+                        spdlog::info("Set minecraftLogPath={}", minecraftLogPath);
+
+                    } else {
+                        spdlog::error("Invalid minecraftLogPath={}", minecraftLogPath);
+                    }
+                }
+
+                if (validLogPaths.size() > 0) {
+                    config.minecraftLogPaths = validLogPaths;
+                }
+
+            } catch (const JSON::json::exception &e) {
                 spdlog::error("Could not load minecraftLogPath");
             }
 
@@ -369,14 +564,35 @@ namespace FL {
 
         data["scale"] = config.scale;
         data["fileDelay"] = config.fileDelay;
+        data["watchTimeout"] = config.watchTimeout;
         data["cachePlayerTime"] = config.cachePlayerTime;
+        data["maxRequests"] = config.maxRequests;
+        data["uuidTimeout"] = config.uuidTimeout;
+        data["profileTimeout"] = config.profileTimeout;
+        data["skinTimeout"] = config.skinTimeout;
+        data["dataTimeout"] = config.dataTimeout;
 
+        data["renderHeads"] = config.renderHeads ? "true" : "false";
         data["renderHeadOverlay"] = config.renderHeadOverlay ? "true" : "false";
         data["fakeFullscreen"] = config.fakeFullscreen ? "true" : "false";
+        data["discoverFromChat"] = config.discoverFromChat ? "true" : "false";
+        data["hedgeRequests"] = config.hedgeRequests ? "true" : "false";
+
+        if (config.apiKeys.size() == 1) {
+            data["apiKey"] = config.apiKeys.front();
 
-        data["apiKey"] = config.apiKey;
+        } else {
+            data["apiKey"] = config.apiKeys;
+        }
         data["displayMode"] = config.displayMode;
-        data["minecraftLogPath"] = config.minecraftLogPath;
+
+        if (config.minecraftLogPaths.size() == 1) {
+            data["minecraftLogPath"] = config.minecraftLogPaths.front();
+
+        } else {
+            data["minecraftLogPath"] = config.minecraftLogPaths;
+        }
+
         data["titleFontPath"] = config.titleFontPath;
         data["statsFontPath"] = config.statsFontPath;
 
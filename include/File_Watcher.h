@@ -0,0 +1,319 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <map>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+namespace FW {
+
+    // Blocks until one of the watched files changes (grows, gets replaced or deleted)
+    // Watches the parent directories so a rotated/recreated file is picked up as well
+    // Uses the OS change notifications (Windows/inotify) when available and falls back to polling otherwise
+    // Another thread can cut a wait short with wake()
+    struct Watcher {
+        std::vector<std::pair<std::string, std::string>> files;  // directory, file name
+        int pollDelay = 100;
+        bool polling = false;  // at least one file couldn't be watched
+
+        // wakes a wait that is only sleeping (no file is watched)
+        std::mutex wakeMutex;
+        std::condition_variable wakeCondition;
+        bool woken = false;
+
+#ifdef _WIN32
+        std::vector<HANDLE> handles;  // one per directory
+        std::vector<std::string> handleDirectories;
+        HANDLE wakeEvent = NULL;
+#elif defined(__linux__)
+        int fd = -1;
+        std::map<int, std::string> watchDirectories;
+        int wakeFd = -1;
+#endif
+
+        Watcher() {
+#ifdef _WIN32
+            wakeEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
+#elif defined(__linux__)
+            wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+        }
+
+        Watcher(const Watcher &) = delete;
+        Watcher &operator=(const Watcher &) = delete;
+
+        ~Watcher() {
+            close();
+
+#ifdef _WIN32
+            if (wakeEvent != NULL) {
+                CloseHandle(wakeEvent);
+            }
+#elif defined(__linux__)
+            if (wakeFd != -1) {
+                ::close(wakeFd);
+            }
+#endif
+        }
+
+        bool add(std::string filePath) {
+            std::string directory, fileName;
+            std::size_t separator = filePath.find_last_of("/\\");
+
+            if (separator == std::string::npos) {
+                directory = ".";
+                fileName = filePath;
+
+            } else {
+                directory = filePath.substr(0, separator);
+                fileName = filePath.substr(separator + 1);
+            }
+
+            if (std::find(files.begin(), files.end(), std::make_pair(directory, fileName)) != files.end()) {
+                return true;
+            }
+
+            files.push_back({directory, fileName});
+
+#ifdef _WIN32
+            if (std::find(handleDirectories.begin(), handleDirectories.end(), directory) == handleDirectories.end()) {
+                // (one wait object is the wake event)
+                if (handles.size() >= MAXIMUM_WAIT_OBJECTS - 1) {
+                    spdlog::warn("Too many directories to watch. Polling every {}ms instead", pollDelay);
+                    polling = true;
+                    return false;
+                }
+
+                HANDLE handle = FindFirstChangeNotificationA(directory.c_str(), FALSE,
+                                                             FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+
+                if (handle == INVALID_HANDLE_VALUE) {
+                    spdlog::warn("Could not watch directory={} (error={}). Polling every {}ms instead", directory, GetLastError(), pollDelay);
+                    polling = true;
+                    return false;
+                }
+
+                handles.push_back(handle);
+                handleDirectories.push_back(directory);
+            }
+
+#elif defined(__linux__)
+            if (fd == -1) {
+                fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            }
+
+            int watchDescriptor = fd == -1 ? -1 : inotify_add_watch(fd, directory.c_str(), IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE);
+
+            if (watchDescriptor == -1) {
+                spdlog::warn("Could not watch directory={}. Polling every {}ms instead", directory, pollDelay);
+                polling = true;
+                return false;
+            }
+
+            watchDirectories[watchDescriptor] = directory;
+
+#else
+            spdlog::info("File change notifications are not supported. Polling every {}ms instead", pollDelay);
+            polling = true;
+            return false;
+#endif
+
+            spdlog::info("Watching directory={} for changes to file={}", directory, fileName);
+            return true;
+        }
+
+        void close() {
+#ifdef _WIN32
+            for (HANDLE handle : handles) {
+                FindCloseChangeNotification(handle);
+            }
+
+            handles.clear();
+            handleDirectories.clear();
+
+#elif defined(__linux__)
+            if (fd != -1) {
+                ::close(fd);
+                fd = -1;
+            }
+
+            watchDirectories.clear();
+#endif
+        }
+
+        bool watching() const {
+#ifdef _WIN32
+            return handles.size() > 0;
+#elif defined(__linux__)
+            return fd != -1 && watchDirectories.size() > 0;
+#else
+            return false;
+#endif
+        }
+
+        // Make the current (or next) wait() return right away
+        void wake() {
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                woken = true;
+            }
+
+            wakeCondition.notify_one();
+
+#ifdef _WIN32
+            if (wakeEvent != NULL) {
+                SetEvent(wakeEvent);
+            }
+#elif defined(__linux__)
+            if (wakeFd != -1) {
+                std::uint64_t count = 1;
+
+                if (::write(wakeFd, &count, sizeof(count)) == -1) {
+                    // the counter is already non-zero, the wait returns either way
+                }
+            }
+#endif
+        }
+
+        // Wait for a change to one of the files, at most timeout ms
+        // Returns true if a file (might have) changed
+        bool wait(int timeout) {
+            if (polling) {
+                timeout = std::min(timeout, pollDelay);
+            }
+
+            if (!watching()) {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+
+                wakeCondition.wait_for(lock, std::chrono::milliseconds(timeout), [this]() {
+                    return woken;
+                });
+
+                woken = false;
+                return true;
+            }
+
+#ifdef _WIN32
+            // The notifications are for whole directories (there's only one log file being written to in each)
+            std::vector<HANDLE> waitHandles = handles;
+
+            if (wakeEvent != NULL) {
+                waitHandles.push_back(wakeEvent);
+            }
+
+            DWORD result = WaitForMultipleObjects(waitHandles.size(), waitHandles.data(), FALSE, timeout);
+
+            if (result < WAIT_OBJECT_0 || result >= WAIT_OBJECT_0 + handles.size()) {
+                return polling;
+            }
+
+            std::size_t index = result - WAIT_OBJECT_0;
+
+            if (!FindNextChangeNotification(handles[index])) {
+                spdlog::warn("Lost the change notification for directory={}. Polling every {}ms instead", handleDirectories[index], pollDelay);
+                FindCloseChangeNotification(handles[index]);
+                handles.erase(handles.begin() + index);
+                handleDirectories.erase(handleDirectories.begin() + index);
+                polling = true;
+            }
+
+            return true;
+
+#elif defined(__linux__)
+            struct pollfd pollDescriptors[2] = {{fd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+
+            if (poll(pollDescriptors, wakeFd == -1 ? 1 : 2, timeout) <= 0) {
+                return polling;
+            }
+
+            if (pollDescriptors[1].revents & POLLIN) {
+                std::uint64_t count;
+
+                if (::read(wakeFd, &count, sizeof(count)) == -1) {
+                    // another wait already reset the counter
+                }
+            }
+
+            if (!(pollDescriptors[0].revents & POLLIN)) {
+                return polling;
+            }
+
+            bool changed = polling;
+            alignas(struct inotify_event) char events[4096];
+            ssize_t length;
+
+            while ((length = ::read(fd, events, sizeof(events))) > 0) {
+                for (char *ptr = events; ptr < events + length;) {
+                    const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(ptr);
+
+                    if (event->len > 0) {
+                        const std::string &directory = watchDirectories[event->wd];
+
+                        for (const auto &file : files) {
+                            if (file.first == directory && file.second == event->name) {
+                                changed = true;
+                            }
+                        }
+                    }
+
+                    ptr += sizeof(struct inotify_event) + event->len;
+                }
+            }
+
+            return changed;
+
+#else
+            return true;
+#endif
+        }
+    };
+
+}  // namespace FW
+
+#endif  // FILE_WATCHER_H
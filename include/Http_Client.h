@@ -0,0 +1,592 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cpr/cpr.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+namespace HC {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Requests are queued per host and sent by worker threads per host, each keeping one
+    // cpr::Session (and so its keep-alive connection) for all its requests. A host gets another
+    // worker when its queue is longer than it has idle workers, up to maxInFlight of them
+    // (but at least MIN_SESSIONS_PER_HOST, so there's a worker left to hedge a slow request)
+    const int MIN_SESSIONS_PER_HOST = 2;
+
+    // How long to stop sending to an upstream after a 429 without a Retry-After header
+    const int DEFAULT_RETRY_AFTER = 60;  // s
+
+    // After BREAKER_THRESHOLD failures in a row an upstream gets no requests for BREAKER_COOLDOWN,
+    // then a single request is let through to see if it's back
+    const int BREAKER_THRESHOLD = 5, BREAKER_COOLDOWN = 30;  // s
+
+    // Connecting gets its own (shorter) deadline, the rest of the request is covered by the request's timeout
+    const std::chrono::milliseconds CONNECT_TIMEOUT(3000);
+
+    // Latencies are kept per host, the last LATENCY_SAMPLES of them
+    // A request taking longer than the host's p95 is sent a second time (hedged) and the first answer wins,
+    // once there are HEDGE_MIN_SAMPLES to go by
+    const int LATENCY_SAMPLES = 200, HEDGE_MIN_SAMPLES = 20, LATENCY_REPORT_INTERVAL = 100;
+
+    int maxInFlight = 8;  // over all hosts
+    bool hedgeRequests = true;
+
+    // Lower is sent first
+    enum Priority {
+        VISIBLE = 0,   // players in the table
+        PREFETCH = 1,  // players that might join soon
+        BACKGROUND = 2
+    };
+
+    // Requests to an upstream share one token bucket (requests = 0 for no limit)
+    struct RateLimit {
+        std::string bucket;
+        int requests = 0, seconds = 0;
+    };
+
+    struct Bucket {
+        double tokens = 0, capacity = 0, refillRate = 0;  // tokens/s
+        Clock::time_point lastRefill = Clock::now(), blockedUntil;
+        int queued = 0;  // requests waiting to use a token
+
+        void refill(Clock::time_point now) {
+            tokens = std::min(capacity, tokens + std::chrono::duration<double>(now - lastRefill).count() * refillRate);
+            lastRefill = now;
+        }
+
+        // When the next request can be sent
+        Clock::time_point available(Clock::time_point now) {
+            refill(now);
+
+            Clock::time_point time = now;
+
+            if (tokens < 1) {
+                time += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>((1 - tokens) / refillRate));
+            }
+
+            return std::max(time, blockedUntil);
+        }
+    };
+
+    struct Request {
+        std::string url;
+        cpr::Parameters parameters;
+        std::string bucket;
+        std::vector<std::shared_ptr<std::atomic<int>>> priorities;  // one per requester sharing it, so they can change while queued
+        std::chrono::milliseconds timeout;                           // 0 for none
+        std::string key;                                             // to share it with identical requests, empty for none
+        std::string body;                                            // JSON, sent as a POST if not empty
+        std::promise<cpr::Response> response;
+        std::shared_future<cpr::Response> future;
+
+        Clock::time_point sentAt;
+        int copies = 0;  // in flight, 2 once hedged
+        bool hedged = false, answered = false;
+
+        // As urgent as its most urgent requester (call with the pool locked)
+        int priority() const {
+            int urgent = BACKGROUND;
+
+            for (const std::shared_ptr<std::atomic<int>> &requester : priorities) {
+                urgent = std::min(urgent, requester->load());
+            }
+
+            return urgent;
+        }
+    };
+
+    struct Host {
+        std::deque<std::shared_ptr<Request>> queue;
+        std::vector<std::shared_ptr<Request>> inFlight;  // not answered yet
+        std::deque<Clock::duration> latencies;
+        int sessions = 0, failures = 0;  // failed requests in a row
+        int samples = 0;                 // since the last latency report
+        Clock::time_point openUntil;     // circuit breaker
+    };
+
+    struct Pool {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::map<std::string, Host> hosts;  // std::map so the workers' Host pointers stay valid
+        std::map<std::string, Bucket> buckets;
+        std::map<std::string, std::shared_ptr<Request>> pending;  // by key, until answered
+        int inFlight = 0;
+        long long duplicates = 0;  // requests that were answered by an identical one
+    };
+
+    // Never destroyed, the detached workers are still waiting on it when the program exits
+    Pool &pool = *new Pool();
+
+    inline std::string hostOf(const std::string &url) {
+        std::size_t start = url.find("://");
+        start = start == std::string::npos ? 0 : start + 3;
+
+        return url.substr(start, url.find('/', start) - start);
+    }
+
+    // Timeouts/connection errors (status 0), rate limits and server errors, worth another try
+    inline bool transientError(long statusCode) {
+        return statusCode == 0 || statusCode == 429 || statusCode >= 500;
+    }
+
+    inline int headerValue(const cpr::Response &response, const std::string &name, int fallback) {
+        auto header = response.header.find(name);
+
+        if (header == response.header.end()) {
+            return fallback;
+        }
+
+        try {
+            return std::stoi(header->second);
+
+        } catch (const std::logic_error &e) {
+            return fallback;
+        }
+    }
+
+    // Correct our estimate of an upstream's budget with what it told us (call with the pool locked)
+    void updateBucket(const std::string &name, const std::string &hostName, const cpr::Response &response) {
+        auto bucket = pool.buckets.find(name);
+
+        if (bucket == pool.buckets.end()) {
+            return;
+        }
+
+        Clock::time_point now = Clock::now();
+        int remaining = headerValue(response, "RateLimit-Remaining", -1), reset = headerValue(response, "RateLimit-Reset", -1);
+
+        bucket->second.refill(now);
+
+        if (remaining >= 0) {
+            bucket->second.tokens = std::min(bucket->second.tokens, (double)remaining);
+
+            if (remaining == 0 && reset > 0) {
+                bucket->second.blockedUntil = now + std::chrono::seconds(reset);
+            }
+        }
+
+        if (response.status_code == 429) {
+            int retryAfter = headerValue(response, "Retry-After", reset > 0 ? reset : DEFAULT_RETRY_AFTER);
+
+            spdlog::warn("Rate limited by host={}, pausing its requests for {}s", hostName, retryAfter);
+
+            bucket->second.tokens = 0;
+            bucket->second.blockedUntil = now + std::chrono::seconds(retryAfter);
+        }
+    }
+
+    // p-th percentile of a host's recent latencies (call with the pool locked)
+    Clock::duration percentile(const Host *host, int p) {
+        if (host->latencies.size() == 0) {
+            return Clock::duration::zero();
+        }
+
+        std::vector<Clock::duration> latencies(host->latencies.begin(), host->latencies.end());
+        auto nth = latencies.begin() + (latencies.size() - 1) * p / 100;
+
+        std::nth_element(latencies.begin(), nth, latencies.end());
+
+        return *nth;
+    }
+
+    void addLatency(Host *host, const std::string &hostName, Clock::duration latency) {
+        host->latencies.push_back(latency);
+
+        if ((int)host->latencies.size() > LATENCY_SAMPLES) {
+            host->latencies.pop_front();
+        }
+
+        if (++host->samples == LATENCY_REPORT_INTERVAL) {
+            host->samples = 0;
+
+            auto ms = [](Clock::duration duration) {
+                return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+            };
+
+            spdlog::info("Latency for host={}: p50={}ms, p95={}ms, p99={}ms (last {} requests)",
+                         hostName, ms(percentile(host, 50)), ms(percentile(host, 95)), ms(percentile(host, 99)), host->latencies.size());
+        }
+    }
+
+    // Open the host's circuit breaker when it keeps failing, close it again on success (call with the pool locked)
+    void updateBreaker(Host *host, const std::string &hostName, long statusCode) {
+        if (statusCode != 429 && transientError(statusCode)) {
+            if (++host->failures == BREAKER_THRESHOLD) {
+                spdlog::warn("Host={} is failing (status code: {}), pausing its requests for {}s", hostName, statusCode, BREAKER_COOLDOWN);
+            }
+
+            if (host->failures >= BREAKER_THRESHOLD) {
+                host->openUntil = Clock::now() + std::chrono::seconds(BREAKER_COOLDOWN);
+            }
+
+        } else {
+            if (host->failures >= BREAKER_THRESHOLD) {
+                spdlog::info("Host={} is back, resuming its requests", hostName);
+            }
+
+            host->failures = 0;
+            host->openUntil = Clock::time_point();
+        }
+    }
+
+    // Pick the most important queued request whose upstream has budget left (call with the pool locked)
+    // Returns the queue's end if there's none, and when to look again in wakeTime
+    std::deque<std::shared_ptr<Request>>::iterator nextRequest(Host *host, Clock::time_point &wakeTime) {
+        Clock::time_point now = Clock::now();
+        auto next = host->queue.end();
+
+        wakeTime = Clock::time_point::max();
+
+        if (now < host->openUntil) {
+            wakeTime = host->openUntil;
+            return next;
+        }
+
+        for (auto request = host->queue.begin(); request != host->queue.end(); ++request) {
+            auto bucket = pool.buckets.find((*request)->bucket);
+
+            if (bucket != pool.buckets.end()) {
+                Clock::time_point available = bucket->second.available(now);
+
+                if (available > now) {
+                    wakeTime = std::min(wakeTime, available);
+                    continue;
+                }
+            }
+
+            // first come first served within a priority
+            if (next == host->queue.end() || (*request)->priority() < (*next)->priority()) {
+                next = request;
+            }
+        }
+
+        return next;
+    }
+
+    // Pick an in flight request that's taking longer than the host's p95 to send again (call with the pool locked)
+    // Returns nullptr if there's none, and updates when to look again in wakeTime
+    std::shared_ptr<Request> nextHedge(Host *host, Clock::time_point &wakeTime) {
+        Clock::time_point now = Clock::now();
+
+        if (!hedgeRequests || (int)host->latencies.size() < HEDGE_MIN_SAMPLES || now < host->openUntil) {
+            return nullptr;
+        }
+
+        Clock::duration threshold = percentile(host, 95);
+
+        for (const std::shared_ptr<Request> &request : host->inFlight) {
+            if (request->hedged) {
+                continue;
+            }
+
+            // only within the upstream's budget
+            Clock::time_point available = request->sentAt + threshold;
+            auto bucket = pool.buckets.find(request->bucket);
+
+            if (bucket != pool.buckets.end()) {
+                available = std::max(available, bucket->second.available(now));
+            }
+
+            if (available > now) {
+                wakeTime = std::min(wakeTime, available);
+                continue;
+            }
+
+            return request;
+        }
+
+        return nullptr;
+    }
+
+    void worker(std::string hostName, Host *host) {
+        cpr::Session session, postSession;  // a session keeps the body once it's set, so POSTs get their own
+
+        spdlog::debug("Started HTTP session for host={}", hostName);
+
+        while (true) {
+            std::shared_ptr<Request> request;
+            Clock::time_point sentAt;
+
+            {
+                std::unique_lock<std::mutex> lock(pool.mutex);
+
+                while (true) {
+                    Clock::time_point wakeTime;
+                    auto next = nextRequest(host, wakeTime);
+                    std::shared_ptr<Request> hedge = nextHedge(host, wakeTime);
+
+                    if (next != host->queue.end() && pool.inFlight < maxInFlight) {
+                        request = std::move(*next);
+                        host->queue.erase(next);
+                        host->inFlight.push_back(request);
+
+                        auto bucket = pool.buckets.find(request->bucket);
+
+                        if (bucket != pool.buckets.end()) {
+                            --bucket->second.queued;
+                        }
+
+                        if (host->failures >= BREAKER_THRESHOLD) {
+                            // half open, hold the others until this one is back
+                            host->openUntil = Clock::now() + std::chrono::seconds(BREAKER_COOLDOWN);
+                        }
+
+                        break;
+                    }
+
+                    if (hedge && pool.inFlight < maxInFlight) {
+                        spdlog::debug("Hedging request to host={} (in flight for longer than p95)", hostName);
+
+                        request = hedge;
+                        request->hedged = true;
+                        break;
+                    }
+
+                    if (next == host->queue.end() && wakeTime != Clock::time_point::max()) {
+                        // every queued request waits for its upstream's budget (or to be hedged)
+                        pool.condition.wait_until(lock, wakeTime);
+
+                    } else {
+                        pool.condition.wait(lock);
+                    }
+                }
+
+                auto bucket = pool.buckets.find(request->bucket);
+
+                if (bucket != pool.buckets.end()) {
+                    bucket->second.tokens -= 1;
+                }
+
+                sentAt = Clock::now();
+
+                if (request->copies++ == 0) {
+                    request->sentAt = sentAt;
+                }
+
+                ++pool.inFlight;
+            }
+
+            cpr::Response response;
+            std::exception_ptr exception;
+
+            try {
+                cpr::Session &requestSession = request->body.size() > 0 ? postSession : session;
+
+                requestSession.SetUrl(cpr::Url{request->url});
+                requestSession.SetParameters(request->parameters);
+                requestSession.SetTimeout(cpr::Timeout{request->timeout});
+                requestSession.SetConnectTimeout(cpr::ConnectTimeout{request->timeout.count() > 0 ? std::min(request->timeout, CONNECT_TIMEOUT) : CONNECT_TIMEOUT});
+
+                if (request->body.size() > 0) {
+                    requestSession.SetHeader(cpr::Header{{"Content-Type", "application/json"}});
+                    requestSession.SetBody(cpr::Body{request->body});
+                    response = requestSession.Post();
+
+                } else {
+                    response = requestSession.Get();
+                }
+
+            } catch (...) {
+                exception = std::current_exception();
+            }
+
+            bool answer = false;
+
+            {
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                --pool.inFlight;
+
+                bool failed = exception || response.status_code == 0;
+
+                updateBreaker(host, hostName, exception ? 0 : response.status_code);
+
+                if (!exception) {
+                    updateBucket(request->bucket, hostName, response);
+                }
+
+                if (!failed) {
+                    addLatency(host, hostName, Clock::now() - sentAt);
+                }
+
+                // the first answer wins, unless it failed and the other copy is still on its way
+                if (--request->copies == 0 || !failed) {
+                    if (!request->answered) {
+                        answer = request->answered = true;
+                        host->inFlight.erase(std::find(host->inFlight.begin(), host->inFlight.end(), request));
+                        pool.pending.erase(request->key);
+                    }
+                }
+            }
+
+            pool.condition.notify_all();
+
+            if (answer) {
+                if (exception) {
+                    request->response.set_exception(exception);
+
+                } else {
+                    request->response.set_value(std::move(response));
+                }
+            }
+        }
+    }
+
+    // Queue a request, the response is ready when the future is
+    // Requests with the same key (ex. the same player) share one request while it's queued or in flight,
+    // it's scheduled by the most urgent of their priorities
+    std::shared_future<cpr::Response> send(std::shared_ptr<Request> request, const RateLimit &rateLimit) {
+        const std::string &url = request->url, &key = request->key;
+        std::shared_future<cpr::Response> response = request->future = request->response.get_future().share();
+
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+
+            if (key.size() > 0) {
+                auto pending = pool.pending.find(key);
+
+                if (pending != pool.pending.end()) {
+                    ++pool.duplicates;
+                    spdlog::debug("Sharing request key={} ({} duplicate requests saved)", key, pool.duplicates);
+
+                    pending->second->priorities.insert(pending->second->priorities.end(), request->priorities.begin(), request->priorities.end());
+                    return pending->second->future;
+                }
+
+                pool.pending[key] = request;
+            }
+
+            if (rateLimit.requests > 0 && pool.buckets.count(rateLimit.bucket) == 0) {
+                Bucket &bucket = pool.buckets[rateLimit.bucket];
+                bucket.capacity = bucket.tokens = rateLimit.requests;
+                bucket.refillRate = rateLimit.requests / (double)rateLimit.seconds;
+            }
+
+            if (rateLimit.requests > 0) {
+                ++pool.buckets[rateLimit.bucket].queued;
+            }
+
+            std::string hostName = hostOf(url);
+            Host &host = pool.hosts[hostName];
+            host.queue.push_back(std::move(request));
+
+            int idleSessions = host.sessions - (int)host.inFlight.size();
+
+            if (host.sessions < MIN_SESSIONS_PER_HOST || (host.sessions < maxInFlight && (int)host.queue.size() > idleSessions)) {
+                ++host.sessions;
+                std::thread(worker, hostName, &host).detach();
+            }
+        }
+
+        pool.condition.notify_all();
+
+        return response;
+    }
+
+    std::shared_future<cpr::Response> get(const std::string &url, const cpr::Parameters &parameters = {}, const RateLimit &rateLimit = {},
+                                          std::shared_ptr<std::atomic<int>> priority = std::make_shared<std::atomic<int>>(VISIBLE),
+                                          std::chrono::milliseconds timeout = std::chrono::milliseconds(0), const std::string &key = "") {
+        std::shared_ptr<Request> request = std::make_shared<Request>();
+        request->url = url;
+        request->parameters = parameters;
+        request->bucket = rateLimit.requests > 0 ? rateLimit.bucket : "";
+        request->priorities = {priority};
+        request->timeout = timeout;
+        request->key = key;
+
+        return send(request, rateLimit);
+    }
+
+    std::shared_future<cpr::Response> post(const std::string &url, const std::string &body, const RateLimit &rateLimit = {},
+                                           std::shared_ptr<std::atomic<int>> priority = std::make_shared<std::atomic<int>>(VISIBLE),
+                                           std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) {
+        std::shared_ptr<Request> request = std::make_shared<Request>();
+        request->url = url;
+        request->body = body;
+        request->bucket = rateLimit.requests > 0 ? rateLimit.bucket : "";
+        request->priorities = {priority};
+        request->timeout = timeout;
+
+        return send(request, rateLimit);
+    }
+
+    // Another requester shares a request that was already sent through send() (its priority counts from now on)
+    void addPriority(const std::shared_ptr<Request> &request, std::shared_ptr<std::atomic<int>> priority) {
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            request->priorities.push_back(priority);
+        }
+
+        pool.condition.notify_all();
+    }
+
+    // Tokens left in a bucket once the requests already queued for it are sent (fallback if it wasn't used yet)
+    double remaining(const std::string &name, double fallback) {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        auto bucket = pool.buckets.find(name);
+
+        if (bucket == pool.buckets.end()) {
+            return fallback;
+        }
+
+        bucket->second.refill(Clock::now());
+
+        return bucket->second.tokens - bucket->second.queued;
+    }
+
+    // For requests shared outside of the pool (ex. batched lookups)
+    void countDuplicate() {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        ++pool.duplicates;
+    }
+
+    long long duplicateRequests() {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        return pool.duplicates;
+    }
+
+}  // namespace HC
+
+#endif  // HTTP_CLIENT_H
@@ -0,0 +1,350 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Chat_Parser.h"
+#include "Log_Tail.h"
+
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+#ifndef LOG_IMPORT_H
+#define LOG_IMPORT_H
+
+namespace LI {
+
+    namespace JSON = nlohmann;
+
+    // Players we've been in a lobby with, built from the client's old (gzipped) logs
+    struct Encounter {
+        long long firstSeen = 0, lastSeen = 0;  // unix time
+        int lobbies = 0;
+
+        void merge(const Encounter &other) {
+            if (lobbies == 0 || other.firstSeen < firstSeen) {
+                firstSeen = other.firstSeen;
+            }
+
+            lastSeen = std::max(lastSeen, other.lastSeen);
+            lobbies += other.lobbies;
+        }
+    };
+
+    struct Index {
+        std::unordered_map<std::string, Encounter> players;
+        std::unordered_map<std::string, long long> archives;  // imported archive -> size (to resume an interrupted import)
+    };
+
+    Index index;
+    std::mutex indexMutex, saveMutex;
+
+    std::string indexFilePath = "./assets/encounters.json";
+
+    // Save every few seconds while importing so an interrupted import doesn't start over
+    const int SAVE_INTERVAL = 5;  // s
+
+    // Compact format: {"archives": {"<path>": size}, "players": {"<name>": [firstSeen, lastSeen, lobbies]}}
+    void load() {
+        std::lock_guard<std::mutex> lock(indexMutex);
+
+        index = {};
+
+        try {
+            std::ifstream fileStream(indexFilePath, std::ios::binary);
+            JSON::json data = JSON::json::parse(fileStream);
+
+            for (const auto &archive : data.at("archives").items()) {
+                index.archives[archive.key()] = archive.value();
+            }
+
+            for (const auto &player : data.at("players").items()) {
+                Encounter &encounter = index.players[player.key()];
+                encounter.firstSeen = player.value().at(0);
+                encounter.lastSeen = player.value().at(1);
+                encounter.lobbies = player.value().at(2);
+            }
+
+            spdlog::info("Loaded {} players from {} imported log archives", index.players.size(), index.archives.size());
+
+        } catch (const JSON::json::exception &e) {
+            spdlog::debug("Could not load encounter index: {}", e.what());
+        }
+    }
+
+    void save() {
+        std::lock_guard<std::mutex> saveLock(saveMutex);
+
+        JSON::json data;
+
+        {
+            std::lock_guard<std::mutex> lock(indexMutex);
+
+            data["archives"] = JSON::json::object();
+            data["players"] = JSON::json::object();
+
+            for (const auto &archive : index.archives) {
+                data["archives"][archive.first] = archive.second;
+            }
+
+            for (const auto &player : index.players) {
+                data["players"][player.first] = {player.second.firstSeen, player.second.lastSeen, player.second.lobbies};
+            }
+        }
+
+        std::ofstream fileStream(indexFilePath, std::ios::binary);
+        fileStream << data.dump();
+    }
+
+    // Archives are named after the day they were written (2022-05-03-1.log.gz)
+    long long archiveDate(const std::string &fileName) {
+        std::tm date = {};
+
+        if (std::sscanf(fileName.c_str(), "%4d-%2d-%2d", &date.tm_year, &date.tm_mon, &date.tm_mday) != 3) {
+            return 0;
+        }
+
+        date.tm_year -= 1900;
+        date.tm_mon -= 1;
+        date.tm_isdst = -1;
+
+        return (long long)std::mktime(&date);
+    }
+
+    // [HH:MM:SS] at the start of the line
+    long long lineTime(std::string_view line, long long date) {
+        if (line.size() < 10 || line[0] != '[' || line[3] != ':' || line[6] != ':' || line[9] != ']') {
+            return date;
+        }
+
+        auto number = [&](int i) {
+            return (line[i] - '0') * 10 + (line[i + 1] - '0');
+        };
+
+        for (int i : {1, 2, 4, 5, 7, 8}) {
+            if (!CP::isDigit(line[i])) {
+                return date;
+            }
+        }
+
+        return date + number(1) * 3600 + number(4) * 60 + number(7);
+    }
+
+    bool decompress(const std::string &filePath, std::string &contents) {
+        gzFile file = gzopen(filePath.c_str(), "rb");
+
+        if (file == NULL) {
+            return false;
+        }
+
+        gzbuffer(file, LT::READ_BUFFER_SIZE);
+
+        std::size_t size = 0;
+        int count;
+
+        do {
+            contents.resize(size + LT::READ_BUFFER_SIZE);
+            count = gzread(file, &contents[size], LT::READ_BUFFER_SIZE);
+
+            if (count > 0) {
+                size += count;
+            }
+
+        } while (count > 0);
+
+        contents.resize(size);
+
+        // (a truncated archive reads like a short one, only gzclose() reports it)
+        int closed = gzclose(file);
+
+        return count == 0 && closed == Z_OK;
+    }
+
+    // Classify every chat line of one archive with the overlay's chat rules
+    bool parseArchive(const std::string &filePath, std::unordered_map<std::string, Encounter> &players) {
+        std::string contents;
+
+        if (!decompress(filePath, contents)) {
+            spdlog::warn("Could not decompress log archive={}", filePath);
+            return false;
+        }
+
+        long long date = archiveDate(std::filesystem::path(filePath).filename().string());
+
+        // the lobby each player was last counted in
+        std::unordered_map<std::string, int> lastLobby;
+        int lobby = 0;
+
+        auto see = [&](std::string username, long long time) {
+            Encounter &encounter = players[username];
+            auto last = lastLobby.find(username);
+
+            if (last == lastLobby.end() || last->second != lobby) {
+                if (encounter.lobbies == 0) {
+                    encounter.firstSeen = time;
+                }
+
+                ++encounter.lobbies;
+                lastLobby[username] = lobby;
+            }
+
+            encounter.lastSeen = std::max(encounter.lastSeen, time);
+        };
+
+        LT::Tail tail(filePath, CP::automaton.lineFilter);
+
+        tail.scanLines(contents.data(), contents.data() + contents.size(), 0, [&](std::string_view line) {
+            CP::ChatLine chatLine = CP::classify(line);
+
+            switch (chatLine.event) {
+                case CP::Event::JOIN_MINI_SERVER:
+                    ++lobby;
+                    break;
+
+                case CP::Event::PLAYER_JOINED:
+                    see(std::string(chatLine.value), lineTime(line, date));
+                    break;
+
+                case CP::Event::WHO_COMMAND:
+                    ++lobby;
+
+                    CP::forEachName(chatLine.value, [&](std::string_view name) {
+                        std::string username(name);
+                        username.erase(std::remove(username.begin(), username.end(), ' '), username.end());
+                        see(username, lineTime(line, date));
+                    });
+
+                    break;
+
+                default:
+                    break;
+            }
+        });
+
+        return true;
+    }
+
+    // Import every *.log.gz in the directories that isn't in the index yet, one archive per thread at a time
+    void importLogs(const std::vector<std::string> &directories, unsigned int threadCount) {
+        std::vector<std::pair<std::string, long long>> archives;
+
+        {
+            std::lock_guard<std::mutex> lock(indexMutex);
+
+            for (const std::string &directory : directories) {
+                std::error_code error;
+
+                for (const auto &entry : std::filesystem::directory_iterator(directory, error)) {
+                    std::string filePath = entry.path().generic_string();
+
+                    if (!entry.is_regular_file(error) || filePath.size() < 7 || filePath.compare(filePath.size() - 7, 7, ".log.gz") != 0) {
+                        continue;
+                    }
+
+                    // archives never change once the game wrote them
+                    if (index.archives.count(filePath) == 0) {
+                        archives.push_back({filePath, (long long)entry.file_size(error)});
+                    }
+                }
+            }
+        }
+
+        if (archives.empty()) {
+            return;
+        }
+
+        threadCount = std::max(1u, std::min<unsigned int>(threadCount, archives.size()));
+        spdlog::info("Importing {} log archives on {} threads", archives.size(), threadCount);
+
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now(), lastSaveTime = startTime;
+        std::atomic<std::size_t> next{0}, failed{0};
+        std::vector<std::thread> threads;
+
+        for (unsigned int i = 0; i < threadCount; ++i) {
+            threads.emplace_back([&]() {
+                for (std::size_t archive = next++; archive < archives.size(); archive = next++) {
+                    std::unordered_map<std::string, Encounter> players;
+
+                    // an archive that couldn't be read is left out of the index, the next import tries it again
+                    if (!parseArchive(archives[archive].first, players)) {
+                        ++failed;
+                        continue;
+                    }
+
+                    bool saveNow = false;
+
+                    {
+                        std::lock_guard<std::mutex> lock(indexMutex);
+
+                        for (const auto &player : players) {
+                            index.players[player.first].merge(player.second);
+                        }
+
+                        index.archives[archives[archive].first] = archives[archive].second;
+
+                        if (std::chrono::steady_clock::now() - lastSaveTime > std::chrono::seconds(SAVE_INTERVAL)) {
+                            lastSaveTime = std::chrono::steady_clock::now();
+                            saveNow = true;
+                        }
+                    }
+
+                    if (saveNow) {
+                        save();
+                    }
+                }
+            });
+        }
+
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+
+        save();
+
+        spdlog::info("Imported {} log archives ({} players) in {}ms", archives.size() - failed, index.players.size(),
+                     std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+
+        if (failed > 0) {
+            spdlog::warn("Could not import {} log archives", failed.load());
+        }
+    }
+
+}  // namespace LI
+
+#endif  // LOG_IMPORT_H
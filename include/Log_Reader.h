@@ -24,21 +24,22 @@ SOFTWARE.
 
 #pragma once
 
+#include "Chat_Parser.h"
 #include "File_Loader.h"
+#include "File_Watcher.h"
+#include "Log_Tail.h"
 #include "Player.h"
 
 #include <spdlog/spdlog.h>
-#include <sys/stat.h>
 
 #include <exception>
 #include <algorithm>
 #include <chrono>
 #include <ctime>
 #include <fstream>
-#include <regex>
-#include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #ifndef LOGREADER_H
@@ -46,17 +47,54 @@ SOFTWARE.
 
 namespace LogParser {
 
-    std::string logFilePath;
-    long long previousFileIndex = 0, previousFileSize = 0;
+    struct StatDelta {
+        int finalKills = 0, finalDeaths = 0, bedsBroken = 0;
+    };
 
+    // One Minecraft client's log file and the lobby that client is currently in
+    struct LogSource {
+        std::string logFilePath;
+        LT::Tail logTail;
+
+        // offset of the lobby switch that started the current lobby (-1 if unknown)
+        long long lobbyOffset = -1, savedOffset = -1, savedLobbyOffset = -1;
+        int lobbyGeneration = 0;  // logTail.generation of the file lobbyOffset points into
+
+        // lines before this offset were written before we started, they are only replayed to rebuild the lobby
+        long long replayEndOffset = 0;
+        int replayGeneration = 0;
+
+        // sent to a mini-server (a game) and not back to a main lobby or limbo since
+        bool inMiniServer = false;
+        std::string miniServer;  // its name
+
+        std::vector<std::string> lobby;  // players in the current lobby
+        std::vector<std::string> joined;  // players who joined since the last applyLobbyChanges()
+        std::vector<std::string> discovered;  // players who chatted in the current lobby since then
+
+        // kill feed of the current game for players whose stats haven't arrived yet (by lowercase username)
+        std::unordered_map<std::string, StatDelta> pendingDeltas;
+    };
+
+    std::vector<std::string> logFilePaths;
+    std::string stateFilePath = "./assets/log_state.json";
+    std::vector<LogSource> sources;
+    FW::Watcher logWatcher;
+    std::chrono::steady_clock::time_point lastStateSaveTime;
+
+    // how far back to look for the current lobby on startup
+    const long long MAX_RESUME_SCAN = 8 * 1024 * 1024;
+    const int STATE_SAVE_INTERVAL = 10;  // s
+
+    // how often to check for responses while fetches are pending
+    const int FETCH_POLL_INTERVAL = 20;  // ms
+
+    // shared by all sources so a player seen by several clients is only fetched once
     std::vector<MPI::Player> players;
 
-    const std::regex joinMiniServerRegex("^\\[\\d\\d:\\d\\d:\\d\\d\\] \\[Client thread/INFO\\]: \\[CHAT\\] (Sending you to mini(\\S+)|       )$"),
-          hasJoinedRegex("^\\[\\d\\d:\\d\\d:\\d\\d\\] \\[Client thread/INFO\\]: \\[CHAT\\] (\\S+) has joined \\((\\d|\\d\\d)/(\\d|\\d\\d)\\)!$"),
-          hasQuitRegex("^\\[\\d\\d:\\d\\d:\\d\\d\\] \\[Client thread/INFO\\]: \\[CHAT\\] (\\S+) has quit!$"),
-          whoCommandRegex("^\\[\\d\\d:\\d\\d:\\d\\d\\] \\[Client thread/INFO\\]: \\[CHAT\\] ONLINE: (.+)$"),
-          apiNewRegex("^\\[\\d\\d:\\d\\d:\\d\\d\\] \\[Client thread/INFO\\]: \\[CHAT\\] Your new API key is (.+)$"),
-          extractCompactChat("(.+) ((\\[x\\d+\\])|(\\(\\d+\\)))$");
+    // Bumped on every lobby switch, hidden players last wanted in an older epoch are stale:
+    // their queued requests drop to background priority and the rest of their fetch chain waits until they show up again
+    int lobbyEpoch = 0;
 
     void filterPlayers() {
         players.erase(std::remove_if(players.begin(), players.end(),
@@ -71,8 +109,10 @@ namespace LogParser {
     }
 
     int find(std::string username) {
+        username = MPI::lowercase(username);
+
         for (std::size_t i = 0; i < players.size(); ++i) {
-            if (username == players[i].username) {
+            if (username == MPI::lowercase(players[i].username)) {
                 return i;
             }
         }
@@ -80,49 +120,153 @@ namespace LogParser {
         return -1;
     }
 
-    void hideAllPlayers() {
-        for (std::size_t i = 0; i < players.size(); ++i) {
-            players[i].render = false;
+    bool inAnyLobby(const std::string &username) {
+        for (const LogSource &source : sources) {
+            if (std::find(source.lobby.begin(), source.lobby.end(), username) != source.lobby.end()) {
+                return true;
+            }
         }
+
+        return false;
     }
 
-    void updateAllPlayers() {
-        // 1. fetch (async)
-        // 2. update aka get data (blocking)
+    // (a restarted client, with a new log file, starts out in a main lobby)
+    bool inGame(const LogSource &source) {
+        return source.inMiniServer && source.lobbyGeneration == source.logTail.generation;
+    }
 
-        // uuid
-        for (std::size_t i = 0; i < players.size(); ++i) {
-            if (players[i].uuid.size() == 0 && players[i].errorMessage.size() == 0) {
-                players[i].updateUUID();
-                players[i].fetchProfile();
-            }
+    // Clients in the same game all log its kill feed, only the first of them is counted
+    bool countsKillFeed(const LogSource &source) {
+        if (!inGame(source)) {
+            return true;
         }
 
-        // profile & fetch skin
-        for (std::size_t i = 0; i < players.size(); ++i) {
-            if (players[i].skinURL.size() == 0 && players[i].errorMessage.size() == 0) {
-                players[i].updateProfile();
-                players[i].fetchSkin();
+        for (const LogSource &other : sources) {
+            if (&other == &source) {
+                return true;
+            }
+
+            if (inGame(other) && other.miniServer == source.miniServer) {
+                return false;
             }
         }
 
-        // profile get skin
+        return true;
+    }
+
+    bool stale(const MPI::Player &player) {
+        return !player.render && player.epoch != lobbyEpoch;
+    }
+
+    // Players on screen are updated first, prefetched (hidden) ones after them
+    std::vector<std::size_t> updateOrder() {
+        std::vector<std::size_t> order(players.size());
+
         for (std::size_t i = 0; i < players.size(); ++i) {
-            if (players[i].skin.size() == 0 && players[i].errorMessage.size() == 0) {
-                players[i].updateSkin();
-                players[i].fetchData();
+            order[i] = i;
+        }
+
+        std::stable_partition(order.begin(), order.end(), [](std::size_t i) {
+            return players[i].render;
+        });
+
+        return order;
+    }
+
+    bool hasStats(const MPI::Player &player) {
+        return player.updated && player.errorMessage.size() == 0 && !player.bedwars.stats.empty();
+    }
+
+    void applyStatDelta(MPI::Player &player, int finalKills, int finalDeaths, int bedsBroken) {
+        player.bedwars.addDelta(FL::config.displayMode, finalKills, finalDeaths, bedsBroken);
+
+        if (finalKills != 0) {
+            player.textures.outdatedCells->fetch_or(MPI::CELL_FK | MPI::CELL_FKDR, std::memory_order_release);
+        }
+
+        if (finalDeaths != 0) {
+            player.textures.outdatedCells->fetch_or(MPI::CELL_FD | MPI::CELL_FKDR, std::memory_order_release);
+        }
+
+        if (bedsBroken != 0) {
+            player.textures.outdatedCells->fetch_or(MPI::CELL_BB, std::memory_order_release);
+        }
+
+        if (player.render && (finalKills != 0 || finalDeaths != 0 || bedsBroken != 0)) {
+            renderUpdate = true;
+        }
+    }
+
+    // Apply a kill feed event to a player's stats
+    // The API only counts a game once it's over, so events from before the stats arrived are kept until they do
+    void addStatDelta(LogSource &source, const std::string &username, int finalKills, int finalDeaths, int bedsBroken) {
+        // other modes (ex. Mini Walls) have final kills too, they aren't Bed Wars stats
+        if (FL::config.mode != FL::Mode::BEDWARS) {
+            return;
+        }
+
+        int playerIndex = find(username);
+
+        if (playerIndex != -1 && hasStats(players[playerIndex])) {
+            applyStatDelta(players[playerIndex], finalKills, finalDeaths, bedsBroken);
+            return;
+        }
+
+        StatDelta &delta = source.pendingDeltas[MPI::lowercase(username)];
+        delta.finalKills += finalKills;
+        delta.finalDeaths += finalDeaths;
+        delta.bedsBroken += bedsBroken;
+    }
+
+    void applyPendingDeltas(MPI::Player &player) {
+        std::string username = MPI::lowercase(player.username);
+
+        for (LogSource &source : sources) {
+            auto delta = source.pendingDeltas.find(username);
+
+            if (delta != source.pendingDeltas.end()) {
+                applyStatDelta(player, delta->second.finalKills, delta->second.finalDeaths, delta->second.bedsBroken);
+                source.pendingDeltas.erase(delta);
             }
         }
+    }
 
-        // Hypixel info
-        for (std::size_t i = 0; i < players.size(); ++i) {
-            if (!players[i].updated && players[i].render && players[i].errorMessage.size() == 0) {
-                players[i].updateData();
+    // Advance every player's fetch chain as far as the responses that already arrived allow
+    // A slow response only holds up its own player, and reading the log never waits on the network
+    void updateAllPlayers() {
+        for (std::size_t i : updateOrder()) {
+            // the scheduler sends the requests of players on screen first
+            // (a request shared with a current player keeps that player's priority, see HC::Request::priority())
+            *players[i].priority = players[i].render ? HC::VISIBLE : stale(players[i]) ? HC::BACKGROUND : HC::PREFETCH;
+
+            bool hadStats = hasStats(players[i]);
+
+            if (players[i].advance(!stale(players[i])) && players[i].updated && players[i].render) {
                 renderUpdate = true;
             }
 
-            players[i].updated = true;
+            if (!hadStats && hasStats(players[i])) {
+                applyPendingDeltas(players[i]);
+            }
+        }
+    }
+
+    // How long the parser can sleep before updateAllPlayers() has something to do again (ms)
+    // Responses are polled for, a request backing off before its retry only needs a wake up at its retry time
+    int fetchWaitTime() {
+        HC::Clock::time_point now = HC::Clock::now(), wakeTime = now + std::chrono::milliseconds(FL::config.watchTimeout);
+
+        for (const MPI::Player &player : players) {
+            if (player.inFlight()) {
+                return FETCH_POLL_INTERVAL;
+            }
+
+            if (!stale(player)) {
+                wakeTime = std::min(wakeTime, std::max(now, player.nextSendTime()));
+            }
         }
+
+        return (int)std::chrono::ceil<std::chrono::milliseconds>(wakeTime - now).count();
     }
 
     void addPlayer(std::string username) {
@@ -131,14 +275,15 @@ namespace LogParser {
         if (playerIndex == -1) {
             spdlog::debug("Adding player={} to queue", username);
             players.push_back(MPI::Player{username});
-
-            players.back().fetchUUID();
+            players.back().epoch = lobbyEpoch;
 
         } else {
-            if (players[playerIndex].errorMessage.length() == 0) {
+            // (a request still in flight would block the erase below)
+            if (players[playerIndex].errorMessage.length() == 0 || !players[playerIndex].finished()) {
                 spdlog::debug("Found player={} in cache", username);
 
                 players[playerIndex].render = true;
+                players[playerIndex].epoch = lobbyEpoch;
 
             } else {
                 spdlog::debug("Reattempting to update player={} due to previous error ({})", username, players[playerIndex].errorMessage);
@@ -146,116 +291,346 @@ namespace LogParser {
                 players.erase(players.begin() + playerIndex);
 
                 players.push_back(MPI::Player{username});
-                players.back().fetchUUID();
+                players.back().epoch = lobbyEpoch;
             }
         }
     }
 
-    void removePlayer(std::string username) {
-        spdlog::debug("Removing player={}", username);
+    // Start fetching a player who isn't in the table yet (ex. chatting in the pre-game lobby)
+    void prefetchPlayer(std::string username) {
         int playerIndex = find(username);
 
-        if (playerIndex == -1) {
+        if (playerIndex != -1) {
+            // still wanted in this lobby
+            players[playerIndex].epoch = lobbyEpoch;
             return;
+        }
 
-        } else {
-            players[playerIndex].render = false;
+        spdlog::debug("Prefetching player={}", username);
+        players.push_back(MPI::Player{username});
+
+        players.back().render = false;
+        players.back().epoch = lobbyEpoch;
+    }
+
+    // Lobby events only record who is where, nothing is fetched until applyLobbyChanges()
+    void joinLobby(LogSource &source, std::string username) {
+        if (std::find(source.lobby.begin(), source.lobby.end(), username) == source.lobby.end()) {
+            source.lobby.push_back(username);
         }
+
+        source.joined.push_back(username);
+    }
+
+    void leaveLobby(LogSource &source, std::string username) {
+        spdlog::debug("Removing player={}", username);
+
+        source.lobby.erase(std::remove(source.lobby.begin(), source.lobby.end(), username), source.lobby.end());
+    }
+
+    void clearLobby(LogSource &source) {
+        source.lobby.clear();
+        source.discovered.clear();
     }
 
-    void parseLine(std::string line) {
-        // try to extract the line from compact chat ([x2])
-        {
-            std::smatch match;
+    // Apply the net result of every lobby event read since the last call
+    // A burst of events (ex. after the parser thread was stalled by a slow request) only costs fetches
+    // for the players who are still in a lobby at the end of it
+    void applyLobbyChanges() {
+        std::vector<std::string> joined;
+        std::size_t events = 0;
 
-            if (std::regex_search(line, match, extractCompactChat)) {
-                line = match[1];
+        for (LogSource &source : sources) {
+            events += source.joined.size();
+
+            for (const std::string &username : source.joined) {
+                if (std::find(source.lobby.begin(), source.lobby.end(), username) != source.lobby.end() &&
+                        std::find(joined.begin(), joined.end(), username) == joined.end()) {
+                    joined.push_back(username);
+                }
             }
+
+            source.joined.clear();
         }
 
-        if (std::regex_match(line, joinMiniServerRegex)) {
-            hideAllPlayers();
+        std::vector<std::string> discovered;
 
-        } else if (std::regex_match(line, hasJoinedRegex)) {
-            std::smatch match;
-            std::regex_search(line, match, hasJoinedRegex);
+        for (LogSource &source : sources) {
+            for (const std::string &username : source.discovered) {
+                if (std::find(discovered.begin(), discovered.end(), username) == discovered.end()) {
+                    discovered.push_back(username);
+                }
+            }
 
-            addPlayer(match.str(1));
+            source.discovered.clear();
+        }
 
-        } else if (std::regex_match(line, hasQuitRegex)) {
-            std::smatch match;
-            std::regex_search(line, match, hasQuitRegex);
+        for (MPI::Player &player : players) {
+            if (player.render && !inAnyLobby(player.username)) {
+                player.render = false;
+                renderUpdate = true;
+            }
+        }
 
-            removePlayer(match.str(1));
+        for (const std::string &username : joined) {
+            addPlayer(username);
+            renderUpdate = true;
+        }
 
-        } else if (std::regex_match(line, whoCommandRegex)) {
-            std::smatch match;
-            std::regex_search(line, match, whoCommandRegex);
+        // after the players who are already there, so they get fetched first
+        for (const std::string &username : discovered) {
+            prefetchPlayer(username);
+        }
 
-            spdlog::debug("Hypixel /who command detected: {}", match.str(1));
+        if (events > joined.size()) {
+            spdlog::debug("Coalesced {} joins into {} player updates", events, joined.size());
+        }
+    }
 
-            hideAllPlayers();
+    void parseLine(LogSource &source, std::string_view line) {
+        CP::ChatLine chatLine = CP::classify(line);
+
+        switch (chatLine.event) {
+            case CP::Event::JOIN_MINI_SERVER:
+                ++lobbyEpoch;
+                source.lobbyOffset = source.logTail.lineOffset;
+                source.lobbyGeneration = source.logTail.generation;
+                clearLobby(source);
+                source.pendingDeltas.clear();
+
+                // (the separator line the rules also count as a lobby switch doesn't name a server)
+                if (!chatLine.value.empty()) {
+                    source.inMiniServer = true;
+                    source.miniServer = std::string(chatLine.value);
+                }
 
-            std::stringstream ss(match.str(1));
-            std::string name;
+                break;
 
-            while (std::getline(ss, name, ',')) {
-                name.erase(std::remove(name.begin(), name.end(), ' '), name.end());
-                addPlayer(name);
-            }
+            case CP::Event::LEAVE_MINI_SERVER:
+                source.inMiniServer = false;
+                source.miniServer.clear();
+                break;
 
-        } else if (std::regex_match(line, apiNewRegex)) {
-            std::smatch match;
-            std::regex_search(line, match, apiNewRegex);
+            case CP::Event::PLAYER_JOINED:
+                joinLobby(source, std::string(chatLine.value));
+                break;
 
-            spdlog::debug("Hypixel /api new command detected");
+            case CP::Event::PLAYER_QUIT:
+                leaveLobby(source, std::string(chatLine.value));
+                break;
 
-            if (MPI::testApiKey(match.str(1))) {
-                FL::config.apiKey = MPI::HYPIXEL_API_KEY;
-                FL::write();
-            }
+            case CP::Event::WHO_COMMAND:
+                spdlog::debug("Hypixel /who command detected: {}", chatLine.value);
+
+                // (not a lobby boundary, the game's kill feed before it is still needed after a restart)
+                clearLobby(source);
+
+                CP::forEachName(chatLine.value, [&source](std::string_view name) {
+                    std::string username(name);
+                    username.erase(std::remove(username.begin(), username.end(), ' '), username.end());
+                    joinLobby(source, username);
+                });
+
+                break;
+
+            case CP::Event::CHAT_MESSAGE:
+                // only chat from the mini-server we're in, the main lobbies are far too busy
+                if (FL::config.discoverFromChat && inGame(source)) {
+                    source.discovered.push_back(std::string(chatLine.value));
+                }
+
+                break;
+
+            case CP::Event::FINAL_KILL:
+                if (!countsKillFeed(source)) {
+                    break;
+                }
+
+                addStatDelta(source, std::string(chatLine.value), 0, 1, 0);
+
+                if (!chatLine.other.empty()) {
+                    addStatDelta(source, std::string(chatLine.other), 1, 0, 0);
+                }
+
+                break;
+
+            case CP::Event::BED_BREAK:
+                if (!countsKillFeed(source)) {
+                    break;
+                }
+
+                addStatDelta(source, std::string(chatLine.value), 0, 0, 1);
+                break;
+
+            case CP::Event::API_NEW:
+                if (source.logTail.generation == source.replayGeneration && source.logTail.lineOffset < source.replayEndOffset) {
+                    // (a key from before a restart was handled back then, it may not even be the newest one)
+                    break;
+                }
+
+                spdlog::debug("Hypixel /api new command detected");
+
+                // the account's old key stops working, it's dropped from the pool on its first 403
+                if (MPI::testApiKey(std::string(chatLine.value))) {
+                    FL::config.apiKeys = MPI::HYPIXEL_API_KEYS;
+                    FL::write();
+                }
+
+                break;
+
+            case CP::Event::IGNORE:
+            case CP::Event::NONE:
+                break;
         }
     }
 
-    long long getFileSize(std::string filePath) {
-        struct stat statBuffer;
-        int res = stat(filePath.c_str(), &statBuffer);
-        return res == 0 ? statBuffer.st_size : -1;
+    bool isLobbyBoundary(std::string_view line) {
+        return CP::classify(line).event == CP::Event::JOIN_MINI_SERVER;
     }
 
-    void readFileUpdates(bool initLoop = false) {
-        long long currentLineIndex = 0, currentFileSize = 0;
-        std::string line;
+    // Remember where we are in each log so a restart can pick up the current lobbies without scanning the whole files
+    void saveState() {
+        lastStateSaveTime = std::chrono::steady_clock::now();
 
-        std::ifstream logFile(logFilePath);
+        bool changed = false;
 
-        if (logFile) {
-            currentFileSize = getFileSize(logFilePath);
+        for (LogSource &source : sources) {
+            if (source.lobbyGeneration != source.logTail.generation) {
+                // the log was rotated since the lobby started
+                source.lobbyOffset = -1;
+            }
 
-            if (currentFileSize < previousFileSize) {
-                // log file was modified or reset
-                previousFileSize = 0;
+            if (source.logTail.file && (source.logTail.consumedOffset() != source.savedOffset || source.lobbyOffset != source.savedLobbyOffset)) {
+                changed = true;
             }
+        }
 
-            while (std::getline(logFile, line, '\n')) {
-                if (currentLineIndex >= previousFileIndex) {
-                    // new line added
-                    if (!initLoop) {
-                        // call callback function
-                        parseLine(line);
-                    }
-                }
+        if (!changed) {
+            return;
+        }
+
+        FL::JSON::ordered_json data = FL::JSON::ordered_json::object();
 
-                ++currentLineIndex;
+        for (LogSource &source : sources) {
+            if (!source.logTail.file) {
+                continue;
             }
 
-            previousFileIndex = currentLineIndex;
-            previousFileSize = currentFileSize;
+            LT::FileIdentity identity = source.logTail.identify();
+
+            FL::JSON::ordered_json &sourceData = data[source.logFilePath];
+            sourceData["device"] = identity.device;
+            sourceData["index"] = identity.index;
+            sourceData["headChecksum"] = identity.headChecksum;
+            sourceData["headSize"] = identity.headSize;
+            sourceData["offset"] = source.logTail.consumedOffset();
+            sourceData["lobbyOffset"] = source.lobbyOffset;
+
+            source.savedOffset = source.logTail.consumedOffset();
+            source.savedLobbyOffset = source.lobbyOffset;
+        }
+
+        std::ofstream fileStream(stateFilePath, std::ios::binary);
+        fileStream << data.dump(4);
+    }
+
+    // Rebuild the current lobby and its kill feed by replaying the log from the last lobby switch
+    // (a /who on the way rebuilds the player list again, so replaying from before it is still correct)
+    void resume(LogSource &source) {
+        // skip every line the chat rules can't match
+        source.logTail = LT::Tail(source.logFilePath, CP::automaton.lineFilter);
+
+        if (!source.logTail.open()) {
+            return;
+        }
+
+        long long fileSize = LT::getFileSize(source.logFilePath), stopOffset = std::max(0LL, fileSize - MAX_RESUME_SCAN), previousLobbyOffset = -1;
+
+        try {
+            std::ifstream fileStream(stateFilePath, std::ios::binary);
+            FL::JSON::json data = FL::JSON::json::parse(fileStream).at(source.logFilePath);
+
+            LT::FileIdentity identity;
+            identity.device = data.at("device");
+            identity.index = data.at("index");
+            identity.headChecksum = data.at("headChecksum");
+            identity.headSize = data.at("headSize");
+
+            long long offset = data.at("offset");
+
+            if (offset <= fileSize && offset >= stopOffset && source.logTail.identify(identity.headSize) == identity) {
+                // only the part written since the last run has to be scanned
+                stopOffset = offset;
+                previousLobbyOffset = data.at("lobbyOffset");
+                spdlog::info("Resuming log file={} from the saved state (offset={}, lobbyOffset={})", source.logFilePath, offset, previousLobbyOffset);
+            }
+
+        } catch (const FL::JSON::json::exception &e) {
+            spdlog::debug("Could not load log state for file={}: {}", source.logFilePath, e.what());
+        }
+
+        source.lobbyOffset = source.logTail.findLastLine(isLobbyBoundary, stopOffset);
+        source.lobbyGeneration = source.logTail.generation;
+        source.replayEndOffset = fileSize;
+        source.replayGeneration = source.logTail.generation;
+
+        if (source.lobbyOffset == -1) {
+            source.lobbyOffset = previousLobbyOffset;
+        }
+
+        if (source.lobbyOffset == -1) {
+            // everything already in the log is from before we started
+            spdlog::info("No lobby found near the end of log file={}", source.logFilePath);
+            source.logTail.skipToEnd();
+
+        } else {
+            spdlog::info("Replaying log file={} from the current lobby (offset={}, size={})", source.logFilePath, source.lobbyOffset, fileSize);
+            source.logTail.seek(source.lobbyOffset);
+        }
+    }
+
+    void openSources() {
+        sources = std::vector<LogSource>(logFilePaths.size());
+
+        for (std::size_t i = 0; i < logFilePaths.size(); ++i) {
+            sources[i].logFilePath = logFilePaths[i];
+
+            logWatcher.add(sources[i].logFilePath);
+            resume(sources[i]);
+        }
+    }
+
+    void readFileUpdates() {
+        if (sources.size() != logFilePaths.size()) {
+            openSources();
+        }
+
+        bool lobbyChanged = false;
+
+        // every client's log is read on this thread, one after another
+        for (LogSource &source : sources) {
+            long long previousLobbyOffset = source.lobbyOffset;
+
+            source.logTail.read([&source](std::string_view line) {
+                // call callback function
+                parseLine(source, line);
+            });
+
+            lobbyChanged |= source.lobbyOffset != previousLobbyOffset;
+        }
+
+        // everything available has been read, only now start fetching
+        applyLobbyChanges();
+
+        if (lobbyChanged ||
+                std::chrono::steady_clock::now() - lastStateSaveTime > std::chrono::seconds(STATE_SAVE_INTERVAL)) {
+            saveState();
         }
     }
 
     void updateLoop() {
-        readFileUpdates(true);
+        logWatcher.pollDelay = FL::config.fileDelay;
+        openSources();
 
         while (running.load()) {
             try {
@@ -270,8 +645,11 @@ namespace LogParser {
                 throw e;
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(FL::config.fileDelay));
+            // sleep until one of the log files changes (or a response might have arrived, or a retry is due)
+            logWatcher.wait(fetchWaitTime());
         }
+
+        spdlog::info("Shared {} duplicate API requests", HC::duplicateRequests());
     }
 
 }  // namespace LogParser
@@ -0,0 +1,697 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <spdlog/spdlog.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <windows.h>
+#endif
+
+
+#ifndef LOG_TAIL_H
+#define LOG_TAIL_H
+
+namespace LT {
+
+    // Lines longer than MAX_LINE_LENGTH are dropped so a garbage line can't grow the buffer
+    const std::size_t READ_BUFFER_SIZE = 256 * 1024, MAX_LINE_LENGTH = 16 * 1024;
+
+    namespace Search {
+
+        // Vectorized replacements for memchr/std::search (AVX2 or SSE2 with a scalar fallback)
+
+        // Scalar versions, used for whatever the vector loops leave over (and as the reference in tests)
+        inline const char *findByteScalar(const char *begin, const char *end, char needle) {
+            const void *match = std::memchr(begin, needle, end - begin);
+            return match == NULL ? end : static_cast<const char *>(match);
+        }
+
+        inline const char *findStringScalar(const char *begin, const char *end, std::string_view needle) {
+            const std::size_t length = needle.size();
+
+            if (length == 0) {
+                return begin;
+            }
+
+            for (; end - begin >= (std::ptrdiff_t)length; ++begin) {
+                begin = findByteScalar(begin, end - length + 1, needle.front());
+
+                if (end - begin < (std::ptrdiff_t)length) {
+                    break;
+                }
+
+                if (std::memcmp(begin + 1, needle.data() + 1, length - 1) == 0) {
+                    return begin;
+                }
+            }
+
+            return end;
+        }
+
+        inline const char *findByte(const char *begin, const char *end, char needle) {
+#if defined(__AVX2__)
+            const __m256i needle32 = _mm256_set1_epi8(needle);
+
+            for (; end - begin >= 32; begin += 32) {
+                __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+                unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle32));
+
+                if (mask != 0) {
+                    return begin + __builtin_ctz(mask);
+                }
+            }
+#endif
+#if defined(__SSE2__)
+            const __m128i needle16 = _mm_set1_epi8(needle);
+
+            for (; end - begin >= 16; begin += 16) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+                unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle16));
+
+                if (mask != 0) {
+                    return begin + __builtin_ctz(mask);
+                }
+            }
+#endif
+            return findByteScalar(begin, end, needle);
+        }
+
+        // Compares the first and last character of the needle at every position at once
+        // and only does a full compare on the positions where both match
+        inline const char *findString(const char *begin, const char *end, std::string_view needle) {
+            const std::size_t length = needle.size();
+
+            if (length < 2) {
+                return length == 0 ? begin : findByte(begin, end, needle.front());
+            }
+
+#if defined(__AVX2__) || defined(__SSE2__)
+            const char *innerNeedle = needle.data() + 1;
+            const std::size_t innerLength = length - 2;
+#endif
+#if defined(__AVX2__)
+            const __m256i first32 = _mm256_set1_epi8(needle.front()), last32 = _mm256_set1_epi8(needle.back());
+
+            for (; end - begin >= (std::ptrdiff_t)(32 + length - 1); begin += 32) {
+                __m256i firstBlock = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin)),
+                        lastBlock = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin + length - 1));
+                unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(firstBlock, first32), _mm256_cmpeq_epi8(lastBlock, last32)));
+
+                while (mask != 0) {
+                    int bit = __builtin_ctz(mask);
+
+                    if (std::memcmp(begin + bit + 1, innerNeedle, innerLength) == 0) {
+                        return begin + bit;
+                    }
+
+                    mask &= mask - 1;
+                }
+            }
+#endif
+#if defined(__SSE2__)
+            const __m128i first16 = _mm_set1_epi8(needle.front()), last16 = _mm_set1_epi8(needle.back());
+
+            for (; end - begin >= (std::ptrdiff_t)(16 + length - 1); begin += 16) {
+                __m128i firstBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin)),
+                        lastBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin + length - 1));
+                unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firstBlock, first16), _mm_cmpeq_epi8(lastBlock, last16)));
+
+                while (mask != 0) {
+                    int bit = __builtin_ctz(mask);
+
+                    if (std::memcmp(begin + bit + 1, innerNeedle, innerLength) == 0) {
+                        return begin + bit;
+                    }
+
+                    mask &= mask - 1;
+                }
+            }
+#endif
+            return findStringScalar(begin, end, needle);
+        }
+
+        inline const char *findLastByte(const char *begin, const char *end, char needle) {
+            while (end != begin) {
+                if (*--end == needle) {
+                    return end;
+                }
+            }
+
+            return NULL;
+        }
+
+    }  // namespace Search
+
+    struct FileDeleter {
+        void operator()(std::FILE *ptr) {
+            if (ptr) {
+                std::fclose(ptr);
+            }
+        }
+    };
+
+    using File = std::unique_ptr<std::FILE, FileDeleter>;
+
+    inline long long getFileSize(const std::string &filePath) {
+        struct stat statBuffer;
+        int res = stat(filePath.c_str(), &statBuffer);
+        return res == 0 ? statBuffer.st_size : -1;
+    }
+
+    // Open a file for reading without locking it. The game has to be able to keep
+    // appending to, rename and delete latest.log while we hold on to it
+    inline File openShared(const std::string &filePath) {
+#ifdef _WIN32
+        HANDLE handle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                    NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+        if (handle == INVALID_HANDLE_VALUE) {
+            return File();
+        }
+
+        int fd = _open_osfhandle((intptr_t)handle, _O_RDONLY | _O_BINARY);
+
+        if (fd == -1) {
+            CloseHandle(handle);
+            return File();
+        }
+
+        std::FILE *file = _fdopen(fd, "rb");
+
+        if (!file) {
+            _close(fd);
+        }
+
+        return File(file);
+#else
+        return File(std::fopen(filePath.c_str(), "rb"));
+#endif
+    }
+
+    // Identifies a file across renames/restarts
+    // (volume + file index/inode, and a checksum of the first bytes in case the index is reused)
+    struct FileIdentity {
+        unsigned long long device = 0, index = 0, headChecksum = 0;
+        long long headSize = 0;
+
+        bool operator==(const FileIdentity &other) const {
+            return device == other.device && index == other.index && headChecksum == other.headChecksum && headSize == other.headSize;
+        }
+
+        bool operator!=(const FileIdentity &other) const {
+            return !(*this == other);
+        }
+    };
+
+    const long long IDENTITY_HEAD_SIZE = 1024;
+
+    // Device and file index of whatever file the path currently points to
+    inline bool pathIdentity(const std::string &filePath, FileIdentity &identity) {
+#ifdef _WIN32
+        HANDLE handle = CreateFileA(filePath.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                    NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+        if (handle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        BY_HANDLE_FILE_INFORMATION information;
+        bool success = GetFileInformationByHandle(handle, &information);
+        CloseHandle(handle);
+
+        if (!success) {
+            return false;
+        }
+
+        identity.device = information.dwVolumeSerialNumber;
+        identity.index = ((unsigned long long)information.nFileIndexHigh << 32) | information.nFileIndexLow;
+#else
+        struct stat statBuffer;
+
+        if (stat(filePath.c_str(), &statBuffer) != 0) {
+            return false;
+        }
+
+        identity.device = statBuffer.st_dev;
+        identity.index = statBuffer.st_ino;
+#endif
+        return true;
+    }
+
+    // FNV-1a
+    inline unsigned long long checksum(const char *data, std::size_t size) {
+        unsigned long long hash = 14695981039346656037ULL;
+
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ (unsigned char)data[i]) * 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    inline int seekFile(std::FILE *file, long long offset, int origin) {
+#ifdef _WIN32
+        return _fseeki64(file, offset, origin);
+#else
+        return fseeko(file, offset, origin);
+#endif
+    }
+
+    // Incremental reader for a file that only ever grows (or gets reset)
+    // Keeps the file open, remembers the byte offset of the last consumed byte and
+    // only reads what was appended since then. An unfinished line at the end of the
+    // file stays at the front of the buffer until the rest of it is written
+    struct Tail {
+        std::string filePath;
+        File file;
+        long long offset = 0;
+
+        // only hand out lines containing this marker (all lines if empty)
+        std::string_view filter;
+
+        // file offset of the line currently passed to the callback
+        long long lineOffset = 0;
+
+        // identity of the open file, to notice when the path gets pointed at a new file
+        FileIdentity identity;
+        int generation = 0;  // number of times a file was (re)opened
+
+        std::vector<char> buffer;
+        std::size_t partialLineSize = 0;
+        bool skipPartialLine = false;
+
+        Tail() {}
+
+        Tail(std::string path, std::string_view lineFilter = std::string_view()) {
+            filePath = path;
+            filter = lineFilter;
+        }
+
+        bool open() {
+            ++generation;
+            file = openShared(filePath);
+            offset = 0;
+            partialLineSize = 0;
+            skipPartialLine = false;
+
+            if (!file) {
+                spdlog::debug("Could not open file={}", filePath);
+                identity = FileIdentity();
+                return false;
+            }
+
+            identity = identify();
+
+            return true;
+        }
+
+        // Size of the open file (which might not be the one at filePath anymore)
+        long long size() {
+#ifdef _WIN32
+            struct _stati64 statBuffer;
+
+            if (_fstati64(_fileno(file.get()), &statBuffer) != 0) {
+                return -1;
+            }
+#else
+            struct stat statBuffer;
+
+            if (fstat(fileno(file.get()), &statBuffer) != 0) {
+                return -1;
+            }
+#endif
+            return statBuffer.st_size;
+        }
+
+        // The path was pointed at another file (the game rotated the log)
+        bool replaced() {
+            FileIdentity current;
+
+            if (!pathIdentity(filePath, current)) {
+                // nothing to switch to yet, keep reading the old file
+                return false;
+            }
+
+            return current.device != identity.device || current.index != identity.index;
+        }
+
+        // The open file was cut short or rewritten from the start
+        bool truncated(long long currentSize) {
+            if (currentSize < offset) {
+                return true;
+            }
+
+            if (identity.headSize == 0 || currentSize == offset) {
+                return false;
+            }
+
+            std::vector<char> head(identity.headSize);
+
+            if (seekFile(file.get(), 0, SEEK_SET) != 0 || std::fread(head.data(), 1, head.size(), file.get()) != head.size()) {
+                std::clearerr(file.get());
+                return true;
+            }
+
+            return checksum(head.data(), head.size()) != identity.headChecksum;
+        }
+
+        // Offset right after the last complete line that was read
+        long long consumedOffset() const {
+            return offset - partialLineSize;
+        }
+
+        // Continue reading from a line start
+        void seek(long long position) {
+            offset = position;
+            partialLineSize = 0;
+            skipPartialLine = false;
+        }
+
+        // Identity of the open file (only the first headSize bytes are checksummed)
+        FileIdentity identify(long long headSize = IDENTITY_HEAD_SIZE) {
+            FileIdentity identity;
+
+            if (!file) {
+                return identity;
+            }
+
+#ifdef _WIN32
+            BY_HANDLE_FILE_INFORMATION information;
+
+            if (GetFileInformationByHandle((HANDLE)_get_osfhandle(_fileno(file.get())), &information)) {
+                identity.device = information.dwVolumeSerialNumber;
+                identity.index = ((unsigned long long)information.nFileIndexHigh << 32) | information.nFileIndexLow;
+            }
+#else
+            struct stat statBuffer;
+
+            if (fstat(fileno(file.get()), &statBuffer) == 0) {
+                identity.device = statBuffer.st_dev;
+                identity.index = statBuffer.st_ino;
+            }
+#endif
+
+            std::vector<char> head(headSize);
+
+            if (seekFile(file.get(), 0, SEEK_SET) == 0) {
+                identity.headSize = std::fread(head.data(), 1, head.size(), file.get());
+                identity.headChecksum = checksum(head.data(), identity.headSize);
+            }
+
+            std::clearerr(file.get());
+
+            return identity;
+        }
+
+        // Scan the complete lines in [stopOffset, end of file) from the back
+        // Returns the offset of the last line (matching the filter) for which predicate(line) is true, -1 if there is none
+        // stopOffset has to be a line start
+        template <typename Predicate>
+        long long findLastLine(Predicate predicate, long long stopOffset = 0) {
+            if (!file && !open()) {
+                return -1;
+            }
+
+            long long position = size();
+
+            // include the newline in front of stopOffset so the line starting there counts as complete
+            long long scanStart = stopOffset > 0 ? stopOffset - 1 : 0;
+
+            std::vector<char> data;
+            std::string carry;  // start of the chunk after the current one, up to its first newline
+
+            while (position > scanStart) {
+                long long size = std::min<long long>(READ_BUFFER_SIZE, position - scanStart);
+                position -= size;
+
+                data.resize(size);
+
+                if (seekFile(file.get(), position, SEEK_SET) != 0 || std::fread(data.data(), 1, size, file.get()) != (std::size_t)size) {
+                    std::clearerr(file.get());
+                    return -1;
+                }
+
+                data.insert(data.end(), carry.begin(), carry.end());
+
+                const char *begin = data.data(), *end = begin + data.size();
+                const char *firstNewline = Search::findByte(begin, end, '\n'), *lastNewline = Search::findLastByte(begin, end, '\n');
+
+                if (lastNewline != NULL) {
+                    // the part before the first newline is only known to be a whole line at the start of the file
+                    const char *linesStart = position == 0 ? begin : firstNewline + 1;
+                    long long found = -1;
+
+                    scanLines(linesStart, lastNewline + 1, position + (linesStart - begin), [&](std::string_view line) {
+                        if (predicate(line)) {
+                            found = lineOffset;
+                        }
+                    });
+
+                    if (found != -1) {
+                        return found;
+                    }
+
+                    carry.assign(begin, firstNewline + 1);
+
+                } else {
+                    carry.assign(begin, end);
+                }
+
+                if (carry.size() > MAX_LINE_LENGTH) {
+                    carry.clear();
+                }
+            }
+
+            return -1;
+        }
+
+        // Jump to the end of the file without reading anything in between
+        void skipToEnd() {
+            if (!file && !open()) {
+                return;
+            }
+
+            if (seekFile(file.get(), 0, SEEK_END) != 0) {
+                return;
+            }
+
+            offset = size();
+
+            if (offset <= 0) {
+                offset = 0;
+                return;
+            }
+
+            // if the last line is still being written, don't hand out its second half as a line
+            char lastCharacter = '\n';
+
+            if (seekFile(file.get(), offset - 1, SEEK_SET) == 0 && std::fread(&lastCharacter, 1, 1, file.get()) == 1) {
+                skipPartialLine = lastCharacter != '\n';
+            }
+
+            partialLineSize = 0;
+            spdlog::debug("Skipped to the end of file={} (offset={})", filePath, offset);
+        }
+
+        // Calls callback(std::string_view line) for every complete line (matching the filter) appended since the last call
+        // The line is only valid for the duration of the callback
+        // When the log is rotated, the rest of the old file is read before switching to the new one
+        // Returns the number of bytes read (-1 if the file could not be read)
+        template <typename Callback>
+        long long read(Callback callback) {
+            if (!file && !open()) {
+                return -1;
+            }
+
+            long long bytesRead = 0;
+
+            if (replaced()) {
+                spdlog::info("File={} was replaced. Finishing the old file (offset={}, size={})", filePath, offset, size());
+
+                // the old file won't be written to anymore, so its last line is complete even without a newline
+                bytesRead += readAppended(callback);
+                flushPartialLine(callback);
+
+                if (!open()) {
+                    return bytesRead;
+                }
+
+            } else {
+                long long currentSize = size();
+
+                if (currentSize < 0) {
+                    return -1;
+                }
+
+                if (truncated(currentSize)) {
+                    // log file was modified or reset (what was written over the old lines is read from the start)
+                    spdlog::info("File={} was reset (size={}, offset={})", filePath, currentSize, offset);
+
+                    if (!open()) {
+                        return -1;
+                    }
+                }
+            }
+
+            bytesRead += readAppended(callback);
+
+            if (identity.headSize < IDENTITY_HEAD_SIZE && offset > identity.headSize) {
+                // the file was tiny when it was opened, checksum more of its head now that it has grown
+                identity = identify();
+            }
+
+            return bytesRead;
+        }
+
+        // Hand out the unfinished line at the end of the buffer as if it was complete
+        template <typename Callback>
+        void flushPartialLine(Callback callback) {
+            if (partialLineSize == 0 || skipPartialLine) {
+                partialLineSize = 0;
+                return;
+            }
+
+            buffer[partialLineSize] = '\n';
+            scanLines(buffer.data(), buffer.data() + partialLineSize + 1, offset - partialLineSize, callback);
+            partialLineSize = 0;
+        }
+
+        // Read everything from offset to the end of the open file
+        template <typename Callback>
+        long long readAppended(Callback callback) {
+            long long currentSize = size();
+
+            if (currentSize < 0 || currentSize == offset) {
+                return 0;
+            }
+
+            if (buffer.size() != READ_BUFFER_SIZE) {
+                buffer.resize(READ_BUFFER_SIZE);
+            }
+
+            std::clearerr(file.get());
+
+            if (seekFile(file.get(), offset, SEEK_SET) != 0) {
+                return 0;
+            }
+
+            long long bytesRead = 0, bufferOffset = offset - partialLineSize;
+            std::size_t count;
+
+            while ((count = std::fread(buffer.data() + partialLineSize, 1, buffer.size() - partialLineSize, file.get())) > 0) {
+                bytesRead += count;
+
+                const char *begin = buffer.data(), *end = begin + partialLineSize + count;
+                const char *lastNewline = Search::findLastByte(begin, end, '\n');
+
+                if (lastNewline == NULL) {
+                    // no complete line yet
+                    partialLineSize += count;
+
+                } else {
+                    if (skipPartialLine) {
+                        skipPartialLine = false;
+                        begin = Search::findByte(begin, end, '\n') + 1;
+                    }
+
+                    scanLines(begin, lastNewline + 1, bufferOffset + (begin - buffer.data()), callback);
+
+                    // move the unfinished line to the front of the buffer
+                    bufferOffset += lastNewline + 1 - buffer.data();
+                    partialLineSize = end - (lastNewline + 1);
+                    std::memmove(buffer.data(), lastNewline + 1, partialLineSize);
+                }
+
+                if (partialLineSize > MAX_LINE_LENGTH) {
+                    spdlog::warn("Dropping line longer than {} bytes in file={}", MAX_LINE_LENGTH, filePath);
+                    bufferOffset += partialLineSize;
+                    partialLineSize = 0;
+                    skipPartialLine = true;
+                }
+            }
+
+            offset += bytesRead;
+
+            return bytesRead;
+        }
+
+        // [begin, end) only contains complete lines, begin is at file offset beginOffset
+        template <typename Callback>
+        void scanLines(const char *begin, const char *end, long long beginOffset, Callback callback) {
+            const char *base = begin;
+
+            while (begin < end) {
+                const char *lineStart = begin;
+
+                if (!filter.empty()) {
+                    // skip straight to the next line containing the marker
+                    const char *marker = Search::findString(begin, end, filter);
+
+                    if (marker == end) {
+                        return;
+                    }
+
+                    const char *previousNewline = Search::findLastByte(begin, marker, '\n');
+                    lineStart = previousNewline == NULL ? begin : previousNewline + 1;
+                    begin = marker + filter.size();
+                }
+
+                const char *lineEnd = Search::findByte(begin, end, '\n');
+                begin = lineEnd + 1;
+
+                if ((std::size_t)(lineEnd - lineStart) > MAX_LINE_LENGTH) {
+                    continue;
+                }
+
+                // the game writes CRLF on Windows
+                if (lineEnd != lineStart && lineEnd[-1] == '\r') {
+                    --lineEnd;
+                }
+
+                lineOffset = beginOffset + (lineStart - base);
+                callback(std::string_view(lineStart, lineEnd - lineStart));
+            }
+        }
+    };
+
+}  // namespace LT
+
+#endif  // LOG_TAIL_H
@@ -25,17 +25,30 @@ SOFTWARE.
 #pragma once
 
 #include "Bedwars.h"
+#include "Http_Client.h"
 #include "Mini_Walls.h"
+#include "Skin_Cache.h"
 #include "Types.h"
+#include "User_Cache.h"
 
 #include <nlohmann/json.hpp>
 #include <cpr/cpr.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
 #include <cmath>
 #include <ctime>
 #include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
 
 #ifndef PLAYER_H
@@ -71,26 +84,54 @@ std::string base64_decode(const std::string &in) {
 
 namespace MPI {
 
+    // Minecraft usernames are case insensitive
+    inline std::string lowercase(std::string username) {
+        std::transform(username.begin(), username.end(), username.begin(), [](unsigned char c) {
+            return std::tolower(c);
+        });
+
+        return username;
+    }
+
     namespace JSON = nlohmann;
 
-    std::string HYPIXEL_API_KEY, MOJANG_API_URL = "https://api.mojang.com/users/profiles/minecraft/",
-                                 MOJANG_SESSION_SERVER_URL = "https://sessionserver.mojang.com/session/minecraft/profile/";
+    std::string MOJANG_BULK_API_URL = "https://api.mojang.com/profiles/minecraft",
+                MOJANG_SESSION_SERVER_URL = "https://sessionserver.mojang.com/session/minecraft/profile/",
+                HYPIXEL_API_PLAYER_URL = "https://api.hypixel.net/player";
+
+    // Valid Hypixel API keys, each has its own rate limit so requests are spread over all of them
+    std::vector<std::string> HYPIXEL_API_KEYS;
 
-    bool apiKeyValid = false;
+    // Published limits, corrected at runtime from the RateLimit-* headers
+    const HC::RateLimit MOJANG_RATE_LIMIT{"api.mojang.com", 600, 600}, SESSION_SERVER_RATE_LIMIT{"sessionserver.mojang.com", 600, 600};
+    const int HYPIXEL_RATE_LIMIT_REQUESTS = 300, HYPIXEL_RATE_LIMIT_SECONDS = 300;  // per key
 
-    cpr::Url HYPIXEL_API_TEST_URL{"https://api.hypixel.net/key"}, HYPIXEL_API_PLAYER_URL{"https://api.hypixel.net/player"};
+    cpr::Url HYPIXEL_API_TEST_URL{"https://api.hypixel.net/key"};
 
+    HC::RateLimit hypixelRateLimit(const std::string &key) {
+        return HC::RateLimit{"api.hypixel.net/" + key, HYPIXEL_RATE_LIMIT_REQUESTS, HYPIXEL_RATE_LIMIT_SECONDS};
+    }
+
+    // Adds the key to the pool if it's valid
     bool testApiKey(std::string key) {
         spdlog::debug("Testing Hypixel API key...");
         cpr::Response response = cpr::Get(HYPIXEL_API_TEST_URL, cpr::Parameters{{"key", key}});
 
-        JSON::json data = JSON::json::parse(response.text);
+        bool apiKeyValid = false;
+
+        try {
+            apiKeyValid = JSON::json::parse(response.text).at("success");
+
+        } catch (const JSON::json::exception &e) {
+            spdlog::error("Could not test Hypixel API key (status code: {})", response.status_code);
+        }
 
-        apiKeyValid = data["success"];
         spdlog::debug("API key status: {}", apiKeyValid);
 
         if (apiKeyValid) {
-            HYPIXEL_API_KEY = key;
+            if (std::find(HYPIXEL_API_KEYS.begin(), HYPIXEL_API_KEYS.end(), key) == HYPIXEL_API_KEYS.end()) {
+                HYPIXEL_API_KEYS.push_back(key);
+            }
 
         } else {
             spdlog::warn("Invalid Hypixel API key (key={})", key);
@@ -99,8 +140,49 @@ namespace MPI {
         return apiKeyValid;
     }
 
-    bool testApiKey() {
-        return testApiKey(HYPIXEL_API_KEY);
+    // The key with the most budget left
+    std::string pickApiKey() {
+        std::string best;
+        double bestRemaining = 0;
+
+        for (const std::string &key : HYPIXEL_API_KEYS) {
+            double remaining = HC::remaining(hypixelRateLimit(key).bucket, HYPIXEL_RATE_LIMIT_REQUESTS);
+
+            if (best.size() == 0 || remaining > bestRemaining) {
+                best = key;
+                bestRemaining = remaining;
+            }
+        }
+
+        return best;
+    }
+
+    // Take a key that was rejected out of rotation, the others keep going
+    void dropApiKey(const std::string &key) {
+        auto position = std::find(HYPIXEL_API_KEYS.begin(), HYPIXEL_API_KEYS.end(), key);
+
+        if (position != HYPIXEL_API_KEYS.end()) {
+            spdlog::error("Hypixel API key={} was rejected, {} key(s) left", key, HYPIXEL_API_KEYS.size() - 1);
+            HYPIXEL_API_KEYS.erase(position);
+        }
+    }
+
+    // The key a Hypixel response was requested with (a shared request may not have used the player's own pick)
+    std::string requestApiKey(const cpr::Response &response, const std::string &fallback) {
+        std::string url = response.url.str();
+        std::size_t start = url.find("?key=");
+
+        if (start == std::string::npos) {
+            start = url.find("&key=");
+        }
+
+        if (start == std::string::npos) {
+            return fallback;
+        }
+
+        start += 5;
+
+        return url.substr(start, url.find('&', start) - start);
     }
 
     namespace XP {
@@ -116,11 +198,25 @@ namespace MPI {
         std::vector<SDL2::Texture> multi;
     };
 
+    // Cells of a player's row that changed since their textures were created
+    enum Cell {
+        CELL_FK = 1 << 0,
+        CELL_FD = 1 << 1,
+        CELL_FKDR = 1 << 2,
+        CELL_BB = 1 << 3,
+        CELL_SKIN = 1 << 4,
+        CELL_ROW = 1 << 5  // the whole row (stats, error or retry message), the first one shows it
+    };
+
     struct PlayerInfoTextures {
-        bool init = false;
+        bool init = false, shown = false;  // (render thread only, shown once the row was handed over with CELL_ROW)
+
+        // Cell flags set by the parser thread, taken (and the cells recreated) by the render thread
+        // (shared so the player stays movable)
+        std::shared_ptr<std::atomic<int>> outdatedCells = std::make_shared<std::atomic<int>>(0);
         SDL2::Texture skin, username, level,
              K, D, KDR,
-             FK, FD, FKDR,
+             FK, FD, FKDR, BB,
              W, L, WLR,
              kit, witherKills, witherDamage,
              arrowsShot, arrowsHit, AHP,
@@ -128,14 +224,243 @@ namespace MPI {
         StarTextures stars;
     };
 
+    // The requests of a player's fetch pipeline
+    enum Request {
+        UUID_REQUEST,     // Mojang name -> UUID
+        PROFILE_REQUEST,  // sessionserver profile (skin URL)
+        SKIN_REQUEST,     // skin texture
+        DATA_REQUEST,     // Hypixel player data
+        REQUEST_COUNT
+    };
+
+    // Each request is sent as soon as the one it depends on is done (REQUEST_COUNT = no dependency)
+    // The Hypixel data only needs the UUID, so it doesn't wait for the head
+    const Request REQUEST_DEPENDENCIES[REQUEST_COUNT] = {REQUEST_COUNT, UUID_REQUEST, PROFILE_REQUEST, UUID_REQUEST};
+
+    // Deadline of each request (ms, 0 for none), one that runs out of time is retried like any transient error
+    int REQUEST_TIMEOUTS[REQUEST_COUNT] = {5000, 5000, 5000, 5000};
+
+    // Name -> UUID lookups are collected for UUID_BATCH_WINDOW and resolved by the bulk endpoint, UUID_BATCH_SIZE names per request
+    // (a full lobby's /who costs two requests instead of sixteen)
+    const int UUID_BATCH_SIZE = 10;
+    const std::chrono::milliseconds UUID_BATCH_WINDOW(50);
+
+    struct UUIDLookup {
+        std::string username;
+        std::vector<std::shared_ptr<std::atomic<int>>> priorities;  // of every player waiting on it
+        std::shared_ptr<HC::Request> request;                       // the batch it was sent in (null while it's queued)
+        std::promise<cpr::Response> response;
+        std::shared_future<cpr::Response> future;
+    };
+
+    struct UUIDBatch {
+        std::mutex mutex;
+        std::map<std::string, std::shared_ptr<UUIDLookup>> lookups;  // by lowercase username, until answered
+        std::vector<std::shared_ptr<UUIDLookup>> queued;  // waiting for the window to close
+    };
+
+    // Never destroyed, like HC::pool
+    UUIDBatch &uuidBatch = *new UUIDBatch();
+
+    // Answer each lookup like the single name endpoint would (200 with id/name, 204 if there's no such player)
+    void answerUUIDLookups(const std::vector<std::shared_ptr<UUIDLookup>> &lookups, cpr::Response response) {
+        std::map<std::string, JSON::json> profiles;
+
+        if (response.status_code == 200) {
+            try {
+                for (const JSON::json &profile : JSON::json::parse(response.text)) {
+                    profiles[lowercase(profile.at("name"))] = profile;
+                }
+
+            } catch (const JSON::json::exception &e) {
+                spdlog::error("Invalid bulk UUID response: {}", e.what());
+                response.status_code = 0;  // retried like a timeout
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(uuidBatch.mutex);
+
+            for (const std::shared_ptr<UUIDLookup> &lookup : lookups) {
+                uuidBatch.lookups.erase(lowercase(lookup->username));
+            }
+        }
+
+        for (const std::shared_ptr<UUIDLookup> &lookup : lookups) {
+            cpr::Response answer = response;
+
+            if (response.status_code == 200) {
+                auto profile = profiles.find(lowercase(lookup->username));
+
+                if (profile != profiles.end()) {
+                    answer.text = profile->second.dump();
+
+                } else {
+                    answer.status_code = 204;
+                    answer.text.clear();
+                }
+            }
+
+            lookup->response.set_value(answer);
+        }
+    }
+
+    void sendUUIDBatches() {
+        std::this_thread::sleep_for(UUID_BATCH_WINDOW);
+
+        std::vector<std::vector<std::shared_ptr<UUIDLookup>>> batches;
+        std::vector<std::shared_ptr<HC::Request>> requests;
+
+        {
+            std::lock_guard<std::mutex> lock(uuidBatch.mutex);
+
+            std::vector<std::shared_ptr<UUIDLookup>> queued;
+            queued.swap(uuidBatch.queued);
+
+            for (std::size_t start = 0; start < queued.size(); start += UUID_BATCH_SIZE) {
+                std::vector<std::shared_ptr<UUIDLookup>> batch(queued.begin() + start, queued.begin() + std::min(queued.size(), start + UUID_BATCH_SIZE));
+                std::shared_ptr<HC::Request> request = std::make_shared<HC::Request>();
+                JSON::json names = JSON::json::array();
+
+                for (const std::shared_ptr<UUIDLookup> &lookup : batch) {
+                    names.push_back(lookup->username);
+
+                    // scheduled as its most urgent player, read when the pool picks a request (players that join later are added by lookupUUID)
+                    request->priorities.insert(request->priorities.end(), lookup->priorities.begin(), lookup->priorities.end());
+                    lookup->request = request;
+                }
+
+                request->url = MOJANG_BULK_API_URL;
+                request->body = names.dump();
+                request->bucket = MOJANG_RATE_LIMIT.bucket;
+                request->timeout = std::chrono::milliseconds(REQUEST_TIMEOUTS[UUID_REQUEST]);
+
+                requests.push_back(request);
+                batches.push_back(std::move(batch));
+            }
+        }
+
+        std::vector<std::shared_future<cpr::Response>> responses;
+
+        for (std::size_t i = 0; i < batches.size(); ++i) {
+            spdlog::debug("Looking up {} UUIDs in one request", batches[i].size());
+            responses.push_back(HC::send(requests[i], MOJANG_RATE_LIMIT));
+        }
+
+        for (std::size_t i = 0; i < batches.size(); ++i) {
+            cpr::Response response;  // status 0 (retried) if the request couldn't be sent
+
+            try {
+                response = responses[i].get();
+
+            } catch (const std::exception &e) {
+                spdlog::error("Bulk UUID request failed: {}", e.what());
+            }
+
+            answerUUIDLookups(batches[i], response);
+        }
+    }
+
+    std::shared_future<cpr::Response> lookupUUID(const std::string &username, std::shared_ptr<std::atomic<int>> priority) {
+        // one invalid name fails the whole batch, and it can't belong to a player anyway
+        if (username.size() > 16 || std::any_of(username.begin(), username.end(), [](unsigned char c) {
+                return !std::isalnum(c) && c != '_';
+            })) {
+            std::promise<cpr::Response> response;
+            cpr::Response noContent;
+            noContent.status_code = 204;
+            response.set_value(noContent);
+
+            return response.get_future().share();
+        }
+
+        std::lock_guard<std::mutex> lock(uuidBatch.mutex);
+
+        std::string key = lowercase(username);
+        auto existing = uuidBatch.lookups.find(key);
+
+        if (existing != uuidBatch.lookups.end()) {
+            HC::countDuplicate();
+
+            if (existing->second->request) {
+                HC::addPriority(existing->second->request, priority);
+
+            } else {
+                existing->second->priorities.push_back(priority);
+            }
+
+            return existing->second->future;
+        }
+
+        std::shared_ptr<UUIDLookup> lookup = std::make_shared<UUIDLookup>();
+        lookup->username = username;
+        lookup->priorities.push_back(priority);
+        lookup->future = lookup->response.get_future().share();
+
+        uuidBatch.lookups[key] = lookup;
+        uuidBatch.queued.push_back(lookup);
+
+        if (uuidBatch.queued.size() == 1) {
+            // the first lookup of a window sends the batch when it closes
+            std::thread(sendUUIDBatches).detach();
+        }
+
+        return lookup->future;
+    }
+
+    enum class RequestState {
+        WAITING,
+        SENT,
+        DONE
+    };
+
+    // Transient errors (see HC::transientError) are retried after BASE_BACKOFF * 2^attempt, capped and jittered by +-50%
+    // Anything else (nicked, no stats, invalid key) is permanent
+    const int MAX_RETRIES = 5;
+    const double BASE_BACKOFF = 1, MAX_BACKOFF = 60;  // s
+
+    // The retry message a row shows, written by the parser thread and read by the render thread
+    struct RetryStatus {
+        std::mutex mutex;
+        std::string message;
+
+        // Returns true if it changed
+        bool set(const std::string &newMessage) {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (message == newMessage) {
+                return false;
+            }
+
+            message = newMessage;
+            return true;
+        }
+
+        std::string get() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return message;
+        }
+    };
+
     struct Player {
         long long timestamp;
-        std::future<cpr::Response> asyncResponse;
+        std::shared_future<cpr::Response> responses[REQUEST_COUNT];  // may be shared with other players (see HC::get)
+        RequestState requestStates[REQUEST_COUNT] = {};
+        int attempts[REQUEST_COUNT] = {};  // retries so far
+        HC::Clock::time_point retryTimes[REQUEST_COUNT];
+        std::string retryMessages[REQUEST_COUNT];  // why a request is being retried, empty when it isn't
+        std::shared_ptr<RetryStatus> retryStatus = std::make_shared<RetryStatus>();  // retryMessage() as the row shows it (shared so the player stays movable)
+        std::shared_ptr<std::atomic<int>> priority = std::make_shared<std::atomic<int>>(HC::VISIBLE);  // of the queued requests
         JSON::json data;
 
         bool canUpdateUUID = false, canUpdateProfile = false, canUpdateData = false, canUpdateSkin = false, updated = false, render = true;
+        bool uuidFromCache = false, skipUserCache = false;  // the UUID came from the client's usercache.json (see retryStaleUUID())
+        int epoch = 0;  // lobby epoch (see LogParser::lobbyEpoch) the player was last wanted in
+        // set by the render thread when the row is drawn with a head, the skin is only fetched then (shared so the player stays movable)
+        std::shared_ptr<std::atomic<bool>> headWanted = std::make_shared<std::atomic<bool>>(false);
 
-        std::string username, mojangUsername, uuid, skinURL, skin, errorMessage;
+        std::string username, mojangUsername, uuid, skinURL, skin, apiKey, errorMessage,
+                    headErrorMessage;  // the row is still shown without a head
         int networkLevel = 1;
 
         BWI::BedWarsInfo bedwars;
@@ -149,7 +474,196 @@ namespace MPI {
         }
 
         // fetch functions are async
-        // update (get data) functions are blocking
+        // update (get data) functions are blocking, unless responseReady()
+
+        bool responseReady(Request request) const {
+            return !responses[request].valid() || responses[request].wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+
+        // The head (profile -> skin) is only fetched once its row needs it
+        bool wanted(Request request) const {
+            return headWanted->load(std::memory_order_acquire) || (request != PROFILE_REQUEST && request != SKIN_REQUEST);
+        }
+
+        // Nothing left to do (until the head is wanted)
+        bool finished() const {
+            for (int i = 0; i < REQUEST_COUNT; ++i) {
+                Request request = (Request)i;
+
+                if (requestStates[request] == RequestState::SENT || (requestStates[request] == RequestState::WAITING && wanted(request))) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool inFlight() const {
+            for (int request = 0; request < REQUEST_COUNT; ++request) {
+                if (requestStates[request] == RequestState::SENT) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // When advance() can send a request again (max() if none is waiting for its retry time)
+        // A request whose dependency isn't done yet waits for the dependency instead
+        HC::Clock::time_point nextSendTime() const {
+            HC::Clock::time_point time = HC::Clock::time_point::max();
+
+            for (int i = 0; i < REQUEST_COUNT; ++i) {
+                Request request = (Request)i, dependency = REQUEST_DEPENDENCIES[i];
+
+                if (requestStates[request] == RequestState::WAITING && wanted(request) &&
+                        (dependency == REQUEST_COUNT || requestStates[dependency] == RequestState::DONE)) {
+                    time = std::min(time, retryTimes[request]);
+                }
+            }
+
+            return time;
+        }
+
+        // Why the player's row is waiting on a retry, empty if it isn't
+        // (a retried UUID is kept until the Hypixel data replaces it, see advance())
+        std::string retryMessage() const {
+            for (Request request : {DATA_REQUEST, UUID_REQUEST}) {
+                if (retryMessages[request].size() > 0) {
+                    return retryMessages[request];
+                }
+            }
+
+            return "";
+        }
+
+        // Send a request again later after a transient error
+        // Returns false once it ran out of retries, the error is permanent then
+        bool retry(Request request, const std::string &message) {
+            if (attempts[request] >= MAX_RETRIES) {
+                return false;
+            }
+
+            static thread_local std::mt19937 generator(std::random_device{}());
+            double backoff = std::min(MAX_BACKOFF, BASE_BACKOFF * (1 << attempts[request])) * std::uniform_real_distribution<double>(0.5, 1.5)(generator);
+
+            ++attempts[request];
+            retryTimes[request] = HC::Clock::now() + std::chrono::duration_cast<HC::Clock::duration>(std::chrono::duration<double>(backoff));
+            retryMessages[request] = message;
+            requestStates[request] = RequestState::WAITING;
+
+            spdlog::debug("Retrying request={} for player={} in {:.1f}s (attempt {}/{}): {}", (int)request, username, backoff, attempts[request], MAX_RETRIES, message);
+
+            if (request == UUID_REQUEST || request == DATA_REQUEST) {
+                // show the row as retrying (handed to the render thread by advance())
+                updated = true;
+            }
+
+            return true;
+        }
+
+        void send(Request request) {
+            switch (request) {
+                case UUID_REQUEST:
+                    fetchUUID();
+                    break;
+
+                case PROFILE_REQUEST:
+                    fetchProfile();
+                    break;
+
+                case SKIN_REQUEST:
+                    fetchSkin();
+                    break;
+
+                case DATA_REQUEST:
+                    fetchData();
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        void receive(Request request) {
+            switch (request) {
+                case UUID_REQUEST:
+                    updateUUID();
+                    break;
+
+                case PROFILE_REQUEST:
+                    updateProfile();
+                    break;
+
+                case SKIN_REQUEST:
+                    updateSkin();
+
+                    if (skin.size() > 0) {
+                        // skin isn't written again, the render thread only reads it after this (before or after the stats are shown)
+                        textures.outdatedCells->fetch_or(CELL_SKIN, std::memory_order_release);
+                    }
+
+                    break;
+
+                case DATA_REQUEST:
+                    updateData();
+
+                    if (requestStates[DATA_REQUEST] == RequestState::DONE) {
+                        updated = true;
+                    }
+
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        // Send every request whose dependency is done and read every response that arrived, never blocks
+        // (a request that can't be sent after an earlier error is done right away, one being retried waits for its retry time)
+        // With sendRequests = false only the requests already sent are read
+        // Returns true if anything changed
+        bool advance(bool sendRequests = true) {
+            bool changed = false, rowChanged = false;
+
+            // dependencies come first, so a whole chain of ready requests is walked in one call
+            for (int i = 0; i < REQUEST_COUNT; ++i) {
+                Request request = (Request)i, dependency = REQUEST_DEPENDENCIES[i];
+
+                if (sendRequests && wanted(request) && requestStates[request] == RequestState::WAITING && HC::Clock::now() >= retryTimes[request] &&
+                        (dependency == REQUEST_COUNT || requestStates[dependency] == RequestState::DONE)) {
+                    send(request);
+                    requestStates[request] = RequestState::SENT;
+                    changed = true;
+                }
+
+                if (requestStates[request] == RequestState::SENT && responseReady(request)) {
+                    // receive() puts it back to waiting if it's retried
+                    requestStates[request] = RequestState::DONE;
+                    receive(request);
+                    responses[request] = {};
+
+                    if (requestStates[request] == RequestState::DONE && request != UUID_REQUEST) {
+                        retryMessages[request].clear();
+                    }
+
+                    // the row is complete (stats or error), a UUID retry stops being shown
+                    if (request == DATA_REQUEST && requestStates[request] == RequestState::DONE) {
+                        retryMessages[UUID_REQUEST].clear();
+                        rowChanged = true;
+                    }
+
+                    changed = true;
+                }
+            }
+
+            // everything the row shows is written before the release, the render thread recreates it after the acquire
+            if (changed && (retryStatus->set(retryMessage()) || rowChanged) && updated) {
+                textures.outdatedCells->fetch_or(CELL_ROW, std::memory_order_release);
+            }
+
+            return changed;
+        }
 
         int fetchUUID() {
             spdlog::debug("Fetching UUID for player={}", username);
@@ -162,9 +676,17 @@ namespace MPI {
 
                 return 0;
 
+            } else if (!skipUserCache && UC::find(username, uuid, mojangUsername)) {
+                // no request needed, the response is already "ready"
+                spdlog::debug("Got UUID for player={} from the user cache (UUID={})", username, uuid);
+                canUpdateUUID = false;
+                uuidFromCache = true;
+
+                return 2;
+
             } else {
                 canUpdateUUID = true;
-                asyncResponse = cpr::GetAsync(cpr::Url{MOJANG_API_URL + username});
+                responses[UUID_REQUEST] = lookupUUID(username, priority);
 
                 return 1;
             }
@@ -177,7 +699,7 @@ namespace MPI {
                 return 0;
 
             } else {
-                cpr::Response response = asyncResponse.get();
+                cpr::Response response = responses[UUID_REQUEST].get();
 
                 if (response.status_code == 200) {
                     data = JSON::json::parse(response.text);
@@ -197,13 +719,20 @@ namespace MPI {
 
                 } else if (response.status_code == 429) {
                     spdlog::debug("Could not update UUID for {}. (Mojang API ratelimited)", username);
-                    errorMessage = "Mojang API ratelimited";
+
+                    if (!retry(UUID_REQUEST, "Mojang API ratelimited")) {
+                        errorMessage = "Mojang API ratelimited";
+                    }
 
                     return 3;
 
                 } else {
                     spdlog::error("Could not update UUID for {}. Mojang API status code: {}", username, response.status_code);
-                    errorMessage = "Mojang API: status_code=" + std::to_string(response.status_code);
+                    std::string message = "Mojang API: status_code=" + std::to_string(response.status_code);
+
+                    if (!HC::transientError(response.status_code) || !retry(UUID_REQUEST, message)) {
+                        errorMessage = message;
+                    }
 
                     return 4;
                 }
@@ -213,25 +742,18 @@ namespace MPI {
         int fetchProfile() {
             spdlog::debug("Fetching Minecraft profile for player={}", username);
 
-            if (errorMessage.size() != 0) {
+            if (uuid.size() == 0) {
                 spdlog::debug("Stopped fetching Minecraft profile due to previous error(s)");
                 canUpdateProfile = false;
 
                 return 0;
 
-            } else if (uuid.size() == 0) {
-                spdlog::critical("THIS SHOULD NOT HAPPEN!! Invalid uuid (size=0), player={}", username);
-                errorMessage = "??? Invalid uuid (size=0)";
-
-                canUpdateProfile = false;
-
-                return 1;
-
             } else {
                 canUpdateProfile = true;
-                asyncResponse = cpr::GetAsync(cpr::Url{MOJANG_SESSION_SERVER_URL + uuid});
+                responses[PROFILE_REQUEST] = HC::get(MOJANG_SESSION_SERVER_URL + uuid, {}, SESSION_SERVER_RATE_LIMIT, priority,
+                                                      std::chrono::milliseconds(REQUEST_TIMEOUTS[PROFILE_REQUEST]), "profile/" + uuid);
 
-                return 2;
+                return 1;
             }
         }
 
@@ -242,13 +764,14 @@ namespace MPI {
                 return 0;
 
             } else {
-                cpr::Response response = asyncResponse.get();
+                cpr::Response response = responses[PROFILE_REQUEST].get();
 
                 if (response.status_code == 200) {
-                    data = JSON::json::parse(base64_decode(JSON::json::parse(response.text).at("properties").at(0).at("value")));
+                    // the Hypixel data may already be in data
+                    JSON::json profile = JSON::json::parse(base64_decode(JSON::json::parse(response.text).at("properties").at(0).at("value")));
 
                     try {
-                        skinURL = data.at("textures").at("SKIN").at("url");
+                        skinURL = profile.at("textures").at("SKIN").at("url");
                         spdlog::debug("Got skin URL for player={} (url={})", username, skinURL);
 
                     } catch (...) {
@@ -267,13 +790,20 @@ namespace MPI {
                     // wiki says it doesn't have one
                     // this check is here just in case
                     spdlog::debug("Could not update skin URL for {}. (Mojang sessionserver ratelimited)", username);
-                    errorMessage = "Mojang sessionserver ratelimited";
+
+                    if (!retry(PROFILE_REQUEST, "Mojang sessionserver ratelimited")) {
+                        headErrorMessage = "Mojang sessionserver ratelimited";
+                    }
 
                     return 3;
 
                 } else {
                     spdlog::error("Could not update skin URL for player={}. Mojang sessionserver status code: {}", username, response.status_code);
-                    errorMessage = "Mojang sessionserver: status_code=" + std::to_string(response.status_code);
+                    std::string message = "Mojang sessionserver: status_code=" + std::to_string(response.status_code);
+
+                    if (!HC::transientError(response.status_code) || !retry(PROFILE_REQUEST, message)) {
+                        headErrorMessage = message;
+                    }
 
                     return 4;
                 }
@@ -283,15 +813,21 @@ namespace MPI {
         int fetchSkin() {
             spdlog::debug("Fetching Minecraft skin for player={}", username);
 
-            if (errorMessage.size() != 0) {
-                spdlog::debug("Stopped fetching Minecraft skin due to previous error(s)");
+            if (skinURL.size() == 0) {
+                spdlog::debug("Stopped fetching Minecraft skin (no skin URL)");
                 canUpdateSkin = false;
 
                 return 0;
 
+            } else if (SC::find(skinURL, skin)) {
+                spdlog::debug("Got Minecraft skin for player={} from the skin cache", username);
+                canUpdateSkin = false;
+
+                return 2;
+
             } else {
                 canUpdateSkin = true;
-                asyncResponse = cpr::GetAsync(cpr::Url{skinURL});
+                responses[SKIN_REQUEST] = HC::get(skinURL, {}, {}, priority, std::chrono::milliseconds(REQUEST_TIMEOUTS[SKIN_REQUEST]), skinURL);
 
                 return 1;
             }
@@ -304,10 +840,11 @@ namespace MPI {
                 return 0;
 
             } else {
-                cpr::Response response = asyncResponse.get();
+                cpr::Response response = responses[SKIN_REQUEST].get();
 
                 if (response.status_code == 200) {
                     skin = response.text;
+                    SC::store(skinURL, skin);
 
                     spdlog::debug("Got Minecraft skin for player={}", username, uuid);
 
@@ -315,7 +852,11 @@ namespace MPI {
 
                 } else {
                     spdlog::error("Could not update skin for player={}. Mojang textures status code: {}", username, response.status_code);
-                    errorMessage = "Mojang textures: status_code=" + std::to_string(response.status_code);
+                    std::string message = "Mojang textures: status_code=" + std::to_string(response.status_code);
+
+                    if (!HC::transientError(response.status_code) || !retry(SKIN_REQUEST, message)) {
+                        headErrorMessage = message;
+                    }
 
                     return 2;
                 }
@@ -325,7 +866,7 @@ namespace MPI {
         int fetchData() {
             spdlog::debug("Fetching Hypixel data for player={}", username);
 
-            if (!apiKeyValid || HYPIXEL_API_KEY.size() == 0) {
+            if (HYPIXEL_API_KEYS.size() == 0) {
                 spdlog::error("Hypixel API key is invalid");
                 errorMessage = "Invalid Hypixel API key";
                 canUpdateData = false;
@@ -346,7 +887,9 @@ namespace MPI {
 
             } else {
                 canUpdateData = true;
-                asyncResponse = cpr::GetAsync(HYPIXEL_API_PLAYER_URL, cpr::Parameters{{"key", HYPIXEL_API_KEY}, {"uuid", uuid}});
+                apiKey = pickApiKey();
+                responses[DATA_REQUEST] = HC::get(HYPIXEL_API_PLAYER_URL, cpr::Parameters{{"key", apiKey}, {"uuid", uuid}}, hypixelRateLimit(apiKey), priority,
+                                                   std::chrono::milliseconds(REQUEST_TIMEOUTS[DATA_REQUEST]), "data/" + uuid);
 
                 return 1;
             }
@@ -359,7 +902,7 @@ namespace MPI {
                 return 0;
 
             } else {
-                cpr::Response response = asyncResponse.get();
+                cpr::Response response = responses[DATA_REQUEST].get();
 
                 if (response.status_code == 200) {
                     data = JSON::json::parse(response.text);
@@ -371,6 +914,7 @@ namespace MPI {
 
                     // make sure the player isn't nicked as someone else (using an existing nickname)
                     if (!verifyUsername()) {
+                        retryStaleUUID();
                         return 2;
                     }
 
@@ -384,20 +928,31 @@ namespace MPI {
 
                 } else if (response.status_code == 403) {
                     spdlog::error("Forbidden response when fetching Hypixel data for player={}", username);
-                    errorMessage = "Forbidden (invalid API key)";
-                    apiKeyValid = false;
+                    dropApiKey(requestApiKey(response, apiKey));
+
+                    // try again with one of the other keys
+                    if (HYPIXEL_API_KEYS.size() == 0 || !retry(DATA_REQUEST, "Forbidden (invalid API key)")) {
+                        errorMessage = "Forbidden (invalid API key)";
+                    }
 
                     return 3;
 
                 } else if (response.status_code == 429) {
                     spdlog::warn("Ratelimit reached when fetching Hypixel data for player={}", username);
-                    errorMessage = "Ratelimit reached (please slow down)";
+
+                    if (!retry(DATA_REQUEST, "Ratelimit reached (please slow down)")) {
+                        errorMessage = "Ratelimit reached (please slow down)";
+                    }
 
                     return 4;
 
                 } else {
                     spdlog::error("Could not fetch Hypixel data for player={}. Hypixel API status code: {}", username, response.status_code);
-                    errorMessage = "Hypixel API: status_code=" + std::to_string(response.status_code);
+                    std::string message = "Hypixel API: status_code=" + std::to_string(response.status_code);
+
+                    if (!HC::transientError(response.status_code) || !retry(DATA_REQUEST, message)) {
+                        errorMessage = message;
+                    }
 
                     return 5;
                 }
@@ -441,6 +996,36 @@ namespace MPI {
             }
         }
 
+        // A name in the usercache may have been taken by someone else since it was cached, so the stats
+        // of a UUID from there that don't match are looked up again over the network before the player counts as nicked
+        bool retryStaleUUID() {
+            if (!uuidFromCache) {
+                return false;
+            }
+
+            spdlog::debug("UUID={} from the user cache is stale for player={}, looking it up again", uuid, username);
+
+            UC::evict(username);
+            uuidFromCache = false;
+            skipUserCache = true;
+
+            uuid.clear();
+            mojangUsername.clear();
+            errorMessage.clear();
+
+            for (Request request : {UUID_REQUEST, DATA_REQUEST}) {
+                requestStates[request] = RequestState::WAITING;
+                attempts[request] = 0;
+            }
+
+            // the head too, unless the stale profile already arrived (its skin isn't written twice, see receive())
+            if (requestStates[PROFILE_REQUEST] != RequestState::DONE) {
+                requestStates[PROFILE_REQUEST] = RequestState::WAITING;
+            }
+
+            return true;
+        }
+
         int calculateLevel() {
             spdlog::debug("Calculating network level for player={}", username);
 
@@ -0,0 +1,187 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <spdlog/spdlog.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+#ifndef SKIN_CACHE_H
+#define SKIN_CACHE_H
+
+namespace SC {
+
+    // Skins are stored by the texture hash that ends their URL, as <directory>/<first 2 characters>/<hash>
+    // The clients' own caches (assets/skins in the game directory) are only read, ours also gets what we download
+    std::string skinDirectory = "./assets/skins";
+    std::vector<std::string> clientSkinDirectories;
+
+    void open(const std::vector<std::string> &logFilePaths) {
+        clientSkinDirectories.clear();
+
+        for (const std::string &logFilePath : logFilePaths) {
+            std::string directory = (std::filesystem::path(logFilePath).parent_path().parent_path() / "assets" / "skins").string();
+
+            if (std::find(clientSkinDirectories.begin(), clientSkinDirectories.end(), directory) == clientSkinDirectories.end()) {
+                clientSkinDirectories.push_back(directory);
+            }
+        }
+    }
+
+    // http://textures.minecraft.net/texture/<hash> -> <hash> (empty if it isn't one)
+    std::string skinHash(const std::string &skinURL) {
+        std::string hash = skinURL.substr(skinURL.find_last_of('/') + 1);
+
+        if (hash.size() < 2 || !std::all_of(hash.begin(), hash.end(), [](char c) {
+                return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+            })) {
+            return "";
+        }
+
+        return hash;
+    }
+
+    std::filesystem::path skinPath(const std::string &directory, const std::string &hash) {
+        return std::filesystem::path(directory) / hash.substr(0, 2) / hash;
+    }
+
+    // A skin is a 64x64 (or old 64x32) PNG, checked chunk by chunk so a file cut short or damaged
+    // (ex. by a crash while a client was writing it) isn't handed to the decoder
+    bool validSkin(const std::string &skin) {
+        const char SIGNATURE[] = "\x89PNG\r\n\x1a\n";
+        const std::size_t SIGNATURE_SIZE = 8;
+
+        if (skin.size() < SIGNATURE_SIZE || std::memcmp(skin.data(), SIGNATURE, SIGNATURE_SIZE) != 0) {
+            return false;
+        }
+
+        auto read32 = [&skin](std::size_t offset) {
+            const unsigned char *bytes = (const unsigned char *)skin.data() + offset;
+            return (std::uint32_t)bytes[0] << 24 | (std::uint32_t)bytes[1] << 16 | (std::uint32_t)bytes[2] << 8 | (std::uint32_t)bytes[3];
+        };
+
+        // length, type, data, CRC of the type and data
+        for (std::size_t offset = SIGNATURE_SIZE; skin.size() - offset >= 12;) {
+            std::uint32_t length = read32(offset);
+
+            if (length > skin.size() - offset - 12) {
+                return false;
+            }
+
+            const char *type = skin.data() + offset + 4;
+
+            if (read32(offset + 8 + length) != crc32(0, (const Bytef *)type, length + 4)) {
+                return false;
+            }
+
+            if (offset == SIGNATURE_SIZE && (std::memcmp(type, "IHDR", 4) != 0 || length < 8 || read32(offset + 8) != 64 ||
+                                             (read32(offset + 12) != 64 && read32(offset + 12) != 32))) {
+                return false;
+            }
+
+            offset += 12 + length;
+
+            if (std::memcmp(type, "IEND", 4) == 0) {
+                return offset == skin.size();
+            }
+        }
+
+        return false;
+    }
+
+    bool find(const std::string &skinURL, std::string &skin) {
+        std::string hash = skinHash(skinURL);
+
+        if (hash.size() == 0) {
+            return false;
+        }
+
+        std::vector<std::string> directories = clientSkinDirectories;
+        directories.insert(directories.begin(), skinDirectory);
+
+        for (const std::string &directory : directories) {
+            std::ifstream file(skinPath(directory, hash), std::ios::binary);
+
+            if (file.good()) {
+                skin.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+                if (validSkin(skin)) {
+                    spdlog::debug("Found skin={} in {}", hash, directory);
+                    return true;
+                }
+
+                spdlog::debug("Skipping invalid skin={} in {}", hash, directory);
+            }
+        }
+
+        return false;
+    }
+
+    void store(const std::string &skinURL, const std::string &skin) {
+        std::string hash = skinHash(skinURL);
+
+        if (hash.size() == 0 || !validSkin(skin)) {
+            return;
+        }
+
+        std::filesystem::path path = skinPath(skinDirectory, hash), temporaryPath = path;
+        temporaryPath += ".tmp";
+        std::error_code error;
+
+        std::filesystem::create_directories(path.parent_path(), error);
+
+        // written next to it and renamed into place, so the cache never has a partly written skin
+        {
+            std::ofstream file(temporaryPath, std::ios::binary);
+            file.write(skin.data(), skin.size());
+
+            if (!file.good()) {
+                spdlog::warn("Could not cache skin={}", hash);
+                file.close();
+                std::filesystem::remove(temporaryPath, error);
+                return;
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, path, error);
+
+        if (error) {
+            spdlog::warn("Could not cache skin={}: {}", hash, error.message());
+            std::filesystem::remove(temporaryPath, error);
+        }
+    }
+
+}  // namespace SC
+
+#endif  // SKIN_CACHE_H
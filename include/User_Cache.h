@@ -0,0 +1,191 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+#ifndef USER_CACHE_H
+#define USER_CACHE_H
+
+namespace UC {
+
+    namespace JSON = nlohmann;
+
+    // The client's own name -> UUID cache (usercache.json in the game directory, next to logs/)
+    // Only used on the parser thread
+    struct Entry {
+        std::string uuid, name;  // undashed like the Mojang API's
+        long long expiresOn = 0;  // unix time
+    };
+
+    struct CacheFile {
+        std::string filePath;
+        std::filesystem::file_time_type lastWriteTime;
+    };
+
+    std::vector<CacheFile> cacheFiles;
+    std::unordered_map<std::string, Entry> entries;  // by lowercase name
+    std::chrono::steady_clock::time_point lastRefreshTime;
+
+    // How often to check the files for changes
+    const int REFRESH_INTERVAL = 5;  // s
+
+    std::string cacheFilePath(const std::string &logFilePath) {
+        return (std::filesystem::path(logFilePath).parent_path().parent_path() / "usercache.json").string();
+    }
+
+    // "2023-05-01 12:34:56 +0200"
+    long long parseExpiry(const std::string &expiresOn) {
+        int year, month, day, hour, minute, second, offset;
+
+        if (std::sscanf(expiresOn.c_str(), "%4d-%2d-%2d %2d:%2d:%2d %5d", &year, &month, &day, &hour, &minute, &second, &offset) != 7) {
+            return 0;
+        }
+
+        // days since 1970-01-01 (from: http://howardhinnant.github.io/date_algorithms.html#days_from_civil)
+        year -= month <= 2;
+        int era = (year >= 0 ? year : year - 399) / 400, yearOfEra = year - era * 400,
+            dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1,
+            dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        long long days = era * 146097LL + dayOfEra - 719468;
+
+        return days * 86400 + hour * 3600 + minute * 60 + second - (offset / 100 * 3600 + offset % 100 * 60);
+    }
+
+    void load(const CacheFile &cacheFile) {
+        std::ifstream file(cacheFile.filePath);
+
+        if (!file.good()) {
+            return;
+        }
+
+        try {
+            JSON::json data = JSON::json::parse(file);
+            int count = 0;
+
+            for (const JSON::json &user : data) {
+                Entry entry;
+                std::string name = user.at("name"), uuid = user.at("uuid");
+
+                entry.name = name;
+                entry.expiresOn = parseExpiry(user.at("expiresOn"));
+                uuid.erase(std::remove(uuid.begin(), uuid.end(), '-'), uuid.end());
+                entry.uuid = uuid;
+
+                std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {
+                    return std::tolower(c);
+                });
+
+                // several clients may know the same player
+                Entry &known = entries[name];
+
+                if (entry.expiresOn >= known.expiresOn) {
+                    known = entry;
+                }
+
+                ++count;
+            }
+
+            spdlog::info("Loaded {} players from the user cache at {}", count, cacheFile.filePath);
+
+        } catch (const JSON::json::exception &e) {
+            spdlog::warn("Could not load the user cache at {}: {}", cacheFile.filePath, e.what());
+        }
+    }
+
+    // Reload the files that changed since the last time
+    void refresh() {
+        lastRefreshTime = std::chrono::steady_clock::now();
+
+        for (CacheFile &cacheFile : cacheFiles) {
+            std::error_code error;
+            std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(cacheFile.filePath, error);
+
+            if (!error && lastWriteTime != cacheFile.lastWriteTime) {
+                cacheFile.lastWriteTime = lastWriteTime;
+                load(cacheFile);
+            }
+        }
+    }
+
+    void open(const std::vector<std::string> &logFilePaths) {
+        cacheFiles.clear();
+        entries.clear();
+
+        for (const std::string &logFilePath : logFilePaths) {
+            cacheFiles.push_back({cacheFilePath(logFilePath), {}});
+        }
+
+        refresh();
+    }
+
+    // Fill in the UUID of a player the client knows about (and hasn't expired yet)
+    bool find(std::string username, std::string &uuid, std::string &name) {
+        if (std::chrono::steady_clock::now() - lastRefreshTime > std::chrono::seconds(REFRESH_INTERVAL)) {
+            refresh();
+        }
+
+        std::transform(username.begin(), username.end(), username.begin(), [](unsigned char c) {
+            return std::tolower(c);
+        });
+
+        auto entry = entries.find(username);
+
+        if (entry == entries.end() || entry->second.expiresOn < (long long)time(NULL)) {
+            return false;
+        }
+
+        uuid = entry->second.uuid;
+        name = entry->second.name;
+
+        return true;
+    }
+
+    // Forget a player whose entry turned out to be stale (ex. the name was taken by someone else since)
+    // (it comes back if the client writes it to the file again)
+    void evict(std::string username) {
+        std::transform(username.begin(), username.end(), username.begin(), [](unsigned char c) {
+            return std::tolower(c);
+        });
+
+        entries.erase(username);
+    }
+
+}  // namespace UC
+
+#endif  // USER_CACHE_H
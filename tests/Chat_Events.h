@@ -0,0 +1,127 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// The regexes parseLine used before CP::classify, and both parsers reduced to the same
+// list of events so they can be compared
+
+#pragma once
+
+#include "../include/Chat_Parser.h"
+
+#include <algorithm>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef CHAT_EVENTS_H
+#define CHAT_EVENTS_H
+
+namespace ChatEvents {
+
+    const std::regex joinMiniServerRegex("^\\[\\d\\d:\\d\\d:\\d\\d\\] \\[Client thread/INFO\\]: \\[CHAT\\] (Sending you to mini(\\S+)|       )$"),
+          hasJoinedRegex("^\\[\\d\\d:\\d\\d:\\d\\d\\] \\[Client thread/INFO\\]: \\[CHAT\\] (\\S+) has joined \\((\\d|\\d\\d)/(\\d|\\d\\d)\\)!$"),
+          hasQuitRegex("^\\[\\d\\d:\\d\\d:\\d\\d\\] \\[Client thread/INFO\\]: \\[CHAT\\] (\\S+) has quit!$"),
+          whoCommandRegex("^\\[\\d\\d:\\d\\d:\\d\\d\\] \\[Client thread/INFO\\]: \\[CHAT\\] ONLINE: (.+)$"),
+          apiNewRegex("^\\[\\d\\d:\\d\\d:\\d\\d\\] \\[Client thread/INFO\\]: \\[CHAT\\] Your new API key is (.+)$"),
+          extractCompactChat("(.+) ((\\[x\\d+\\])|(\\(\\d+\\)))$");
+
+    // What the old parseLine did with the line
+    inline std::vector<std::string> fromRegexes(std::string line) {
+        std::vector<std::string> events;
+        std::smatch match;
+
+        if (std::regex_search(line, match, extractCompactChat)) {
+            line = match[1];
+        }
+
+        if (std::regex_match(line, joinMiniServerRegex)) {
+            events.push_back("hide");
+
+        } else if (std::regex_match(line, match, hasJoinedRegex)) {
+            events.push_back("add " + match.str(1));
+
+        } else if (std::regex_match(line, match, hasQuitRegex)) {
+            events.push_back("remove " + match.str(1));
+
+        } else if (std::regex_match(line, match, whoCommandRegex)) {
+            events.push_back("hide");
+
+            std::stringstream ss(match.str(1));
+            std::string name;
+
+            while (std::getline(ss, name, ',')) {
+                name.erase(std::remove(name.begin(), name.end(), ' '), name.end());
+                events.push_back("add " + name);
+            }
+
+        } else if (std::regex_match(line, match, apiNewRegex)) {
+            events.push_back("api " + match.str(1));
+        }
+
+        return events;
+    }
+
+    // The same for CP::classify (events the regexes didn't know about are left out)
+    inline std::vector<std::string> fromClassifier(std::string_view line) {
+        std::vector<std::string> events;
+        CP::ChatLine chatLine = CP::classify(line);
+
+        switch (chatLine.event) {
+            case CP::Event::JOIN_MINI_SERVER:
+                events.push_back("hide");
+                break;
+
+            case CP::Event::PLAYER_JOINED:
+                events.push_back("add " + std::string(chatLine.value));
+                break;
+
+            case CP::Event::PLAYER_QUIT:
+                events.push_back("remove " + std::string(chatLine.value));
+                break;
+
+            case CP::Event::WHO_COMMAND:
+                events.push_back("hide");
+
+                CP::forEachName(chatLine.value, [&](std::string_view name) {
+                    std::string username(name);
+                    username.erase(std::remove(username.begin(), username.end(), ' '), username.end());
+                    events.push_back("add " + username);
+                });
+                break;
+
+            case CP::Event::API_NEW:
+                events.push_back("api " + std::string(chatLine.value));
+                break;
+
+            default:
+                break;
+        }
+
+        return events;
+    }
+
+}  // namespace ChatEvents
+
+#endif  // CHAT_EVENTS_H
@@ -0,0 +1,149 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Differential test of CP::classify (with the default rules) against the regexes it replaced:
+// both have to produce the same events for every line
+// The lines of tests/data/chat_corpus.log (a client log of a Bed Wars game) also have to use every one of the rules
+
+#include "include/Chat_Parser.h"
+#include "tests/Chat_Events.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+int failures = 0;
+
+void compare(const std::string &line) {
+    std::vector<std::string> expected = ChatEvents::fromRegexes(line), actual = ChatEvents::fromClassifier(line);
+
+    if (expected == actual) {
+        return;
+    }
+
+    if (++failures <= 10) {
+        std::printf("Mismatch for line=\"%s\"\n", line.c_str());
+
+        for (const std::string &event : expected) {
+            std::printf("  regex:      %s\n", event.c_str());
+        }
+
+        for (const std::string &event : actual) {
+            std::printf("  classifier: %s\n", event.c_str());
+        }
+    }
+}
+
+// Index of the first rule that matches each line (-1 for none), from automatons of the first 1, 2, ... rules
+std::vector<int> matchingRules(const std::vector<std::string> &lines) {
+    nlohmann::json rules = nlohmann::json::parse(CP::DEFAULT_RULES);
+    std::vector<int> matching(lines.size(), -1);
+
+    // (one "Compiled ... rules" message for each of them otherwise)
+    spdlog::set_level(spdlog::level::warn);
+
+    for (std::size_t count = 1; count <= rules["rules"].size(); ++count) {
+        nlohmann::json firstRules = rules;
+        firstRules["rules"].erase(firstRules["rules"].begin() + count, firstRules["rules"].end());
+        CP::Automaton automaton = CP::compile(firstRules);
+
+        for (std::size_t i = 0; i < lines.size(); ++i) {
+            if (matching[i] == -1 && automaton.classify(CP::stripCompactChat(lines[i])).event != CP::Event::NONE) {
+                matching[i] = count - 1;
+            }
+        }
+    }
+
+    return matching;
+}
+
+int main() {
+    CP::automaton = CP::compile(nlohmann::json::parse(CP::DEFAULT_RULES));
+
+    std::vector<std::string> corpus;
+    std::ifstream corpusFile(CHAT_CORPUS_PATH, std::ios::binary);
+
+    for (std::string line; std::getline(corpusFile, line);) {
+        corpus.push_back(line);
+        compare(line);
+    }
+
+    std::vector<int> matching = matchingRules(corpus);
+    std::vector<nlohmann::json> rules = nlohmann::json::parse(CP::DEFAULT_RULES)["rules"];
+
+    for (std::size_t rule = 0; rule < rules.size(); ++rule) {
+        if (std::find(matching.begin(), matching.end(), (int)rule) == matching.end()) {
+            ++failures;
+            std::printf("No corpus line for rule=%s\n", rules[rule].dump().c_str());
+        }
+    }
+
+    const std::vector<std::string> lines = {
+        "[12:34:56] [Client thread/INFO]: [CHAT] Sending you to mini123ABC",
+        "[12:34:56] [Client thread/INFO]: [CHAT]        ",
+        "[12:34:56] [Client thread/INFO]: [CHAT] Bob has joined (1/16)!",
+        "[12:34:56] [Client thread/INFO]: [CHAT] Bob has joined (12/16)! [x3]",
+        "[12:34:56] [Client thread/INFO]: [CHAT] Bob has joined (123/16)!",
+        "[12:34:56] [Client thread/INFO]: [CHAT] Bob has quit! (2)",
+        "[12:34:56] [Client thread/INFO]: [CHAT] ONLINE: a, b, c",
+        "[12:34:56] [Client thread/INFO]: [CHAT] ONLINE: a,, b, ",
+        "[12:34:56] [Client thread/INFO]: [CHAT] ONLINE: has joined (1/2)!",
+        "[12:34:56] [Client thread/INFO]: [CHAT] Your new API key is abc-def (2)",
+        "[12:34:56] [Client thread/INFO]: [CHAT] [MVP+] Bob: Bob has joined (1/16)!",
+        "[12:34:56] [Client thread/INFO]: Connecting to mc.hypixel.net., 25565",
+    };
+
+    for (const std::string &line : lines) {
+        compare(line);
+    }
+
+    // random lines glued together from pieces of the patterns
+    const std::vector<std::string> prefixes = {
+        "[12:34:56] [Client thread/INFO]: [CHAT] ", "[1:34:56] [Client thread/INFO]: [CHAT] ",
+        "[12:34:56] [Client thread/INFO]: [CHAT]", "[12:34:56] [Render thread/INFO]: [CHAT] ", ""};
+    const std::vector<std::string> pieces = {
+        "Sending you to mini", "       ", "      ", "Bob has joined (", "Bob has quit!", " has quit!", "ONLINE: ", "ONLINE:",
+        "Your new API key is ", "a", "b c", ",", ", ", " ", "1", "12", "123", "/", ")!", "!", " [x", "2]", "(3)", " (4)",
+        " [x5]", "x", "\t", "mini", "[VIP] Bob: hi", "Sending", "\r"};
+
+    std::mt19937 rng(5);
+    const int RANDOM_LINES = 20000;
+
+    for (int i = 0; i < RANDOM_LINES; ++i) {
+        std::string line = prefixes[rng() % prefixes.size()];
+
+        for (int count = rng() % 6; count > 0; --count) {
+            line += pieces[rng() % pieces.size()];
+        }
+
+        compare(line);
+    }
+
+    std::printf("%zu lines, %d failures\n", corpus.size() + lines.size() + RANDOM_LINES, failures);
+
+    return failures == 0 ? 0 : 1;
+}
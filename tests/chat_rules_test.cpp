@@ -0,0 +1,124 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// What the default rules make of the lines the regexes never handled: the kill feed, chat
+// and the lines that only look like them (ex. a kill feed line quoted in a private message)
+
+#include "include/Chat_Parser.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct Expectation {
+    std::string line, event, value, other;
+};
+
+std::string eventName(CP::Event event) {
+    for (const std::pair<std::string, CP::Event> &name : CP::EVENT_NAMES) {
+        if (name.second == event) {
+            return name.first;
+        }
+    }
+
+    return "none";
+}
+
+int main() {
+    CP::automaton = CP::compile(nlohmann::json::parse(CP::DEFAULT_RULES));
+
+    const std::string PREFIX = "[12:34:56] [Client thread/INFO]: [CHAT] ";
+
+    const std::vector<Expectation> expectations = {
+        // final kills, the killer is optional
+        {"Alice was killed by Bob. FINAL KILL!", "final_kill", "Alice", "Bob"},
+        {"Alice was knocked into the void by Bob_2. FINAL KILL!", "final_kill", "Alice", "Bob_2"},
+        {"Alice fell into the void. FINAL KILL!", "final_kill", "Alice", ""},
+        {"Alice was killed by Bob. FINAL KILL! [x2]", "final_kill", "Alice", "Bob"},
+
+        // kills by a player's golem or silverfish are the player's
+        {"Alice was killed by Bob's Iron Golem. FINAL KILL!", "final_kill", "Alice", "Bob"},
+        {"Alice was bitten by Bob's Silverfish. FINAL KILL!", "final_kill", "Alice", "Bob"},
+
+        {"BED DESTRUCTION > Red Bed was destroyed by Bob!", "bed_break", "Bob", ""},
+        {"BED DESTRUCTION > Blue Bed was iced by Bob_2!", "bed_break", "Bob_2", ""},
+
+        {"[VIP] Bob: hi", "chat_message", "Bob", ""},
+        {"[MVP+] Bob: hi", "chat_message", "Bob", ""},
+        {"[MVP++] Bob: hi", "chat_message", "Bob", ""},
+        {"Bob: hi", "chat_message", "Bob", ""},
+        {"Bo: hi", "none", "", ""},
+
+        // chat quoting the kill feed is still chat
+        {"[MVP+] Bob: Alice was killed by Carl. FINAL KILL!", "chat_message", "Bob", ""},
+        {"Bob: Alice was killed by Carl. FINAL KILL!", "chat_message", "Bob", ""},
+        {"Bob: BED DESTRUCTION > Red Bed was destroyed by Carl!", "chat_message", "Bob", ""},
+
+        // and so are messages from other channels
+        {"From [MVP+] Bob: Alice was killed by Carl. FINAL KILL!", "ignore", "", ""},
+        {"From Bob: Alice was killed by Carl. FINAL KILL!", "ignore", "", ""},
+        {"To [VIP] Bob: Alice was killed by Carl. FINAL KILL!", "ignore", "", ""},
+        {"To Bob: BED DESTRUCTION > Red Bed was destroyed by Carl!", "ignore", "", ""},
+        {"Party > [MVP+] Bob: Alice was killed by Carl. FINAL KILL!", "ignore", "", ""},
+        {"Guild > Bob: Alice was killed by Carl. FINAL KILL!", "ignore", "", ""},
+        {"Officer > [VIP] Bob: BED DESTRUCTION > Red Bed was destroyed by Carl!", "ignore", "", ""},
+
+        // system lines that look like chat
+        {"Tip: Alice was killed by Carl. FINAL KILL!", "ignore", "", ""},
+        {"Party: Bob has joined the party", "ignore", "", ""},
+        {"Guild: Bob joined.", "ignore", "", ""},
+        {"Friend: Bob joined.", "ignore", "", ""},
+        {"Note: hi", "ignore", "", ""},
+        {"Warning: hi", "ignore", "", ""},
+        {"Error: hi", "ignore", "", ""},
+        {"Reward: 10 coins", "ignore", "", ""},
+        {"Map: Lighthouse", "ignore", "", ""},
+        {"Mode: Fours", "ignore", "", ""},
+        {"Team: Red", "ignore", "", ""},
+
+        // players named like the channels
+        {"From was killed by To. FINAL KILL!", "final_kill", "From", "To"},
+        {"To was killed by From's Iron Golem. FINAL KILL!", "final_kill", "To", "From"},
+        {"From has joined (2/8)!", "player_joined", "From", ""},
+        {"From: hi", "chat_message", "From", ""},
+        {"[VIP] Party: hi", "chat_message", "Party", ""},
+    };
+
+    int failures = 0;
+
+    for (const Expectation &expected : expectations) {
+        CP::ChatLine chatLine = CP::classify(PREFIX + expected.line);
+        std::string event = eventName(chatLine.event), value(chatLine.value), other(chatLine.other);
+
+        if (event != expected.event || value != expected.value || other != expected.other) {
+            ++failures;
+            std::printf("Line=\"%s\": expected %s \"%s\" \"%s\", got %s \"%s\" \"%s\"\n", expected.line.c_str(),
+                        expected.event.c_str(), expected.value.c_str(), expected.other.c_str(), event.c_str(), value.c_str(), other.c_str());
+        }
+    }
+
+    std::printf("%zu lines, %d failures\n", expectations.size(), failures);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Stress test for LT::Tail: a writer appends numbered chat lines (split into several writes,
+// with other lines in between) while the log is rotated and truncated under the reader.
+// Every chat line has to be read exactly once and in order
+
+#include "include/Log_Tail.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+const int CHAT_LINES = 200000, RESET_INTERVAL = 10000;
+
+std::atomic<long long> received(0);
+std::atomic<bool> writing(true), failed(false);
+
+// held by the reader while it reads, so the writer can keep it away from the file
+std::mutex readerMutex;
+
+// Waits until the reader has caught up to count lines (false if it never does)
+bool waitForReader(long long count) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+    while (received.load() < count) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+
+        std::this_thread::yield();
+    }
+
+    return true;
+}
+
+void writeLog(const std::filesystem::path &directory, const std::string &filePath) {
+    std::mt19937 rng(9);
+    std::FILE *file = std::fopen(filePath.c_str(), "wb");
+    std::unique_lock<std::mutex> hold(readerMutex, std::defer_lock);
+    int rotations = 0, truncations = 0, rewrites = 0;
+    long long fileStart = 0, fileSize = 0, previousSize = 0;
+
+    for (int i = 0; i < CHAT_LINES; ++i) {
+        if (i > 0 && i % RESET_INTERVAL == 0) {
+            if (hold.owns_lock()) {
+                hold.unlock();
+            }
+
+            std::fclose(file);
+            file = NULL;
+
+            if (rng() % 2 == 0) {
+                // what was not read before the truncation is gone, so let the reader catch up first
+                if (!waitForReader(i)) {
+                    failed = true;
+                    break;
+                }
+
+                ++truncations;
+
+                if (rng() % 2 == 0) {
+                    // the file grows past the old offset before the reader looks at it again,
+                    // so the truncation can only be noticed by the changed head of the file
+                    hold.lock();
+                    previousSize = fileSize;
+                    ++rewrites;
+                }
+
+            } else {
+                // the game only rotates once per launch/day, so the reader has opened the current file by then
+                if (!waitForReader(fileStart + 1)) {
+                    failed = true;
+                    break;
+                }
+
+                std::filesystem::rename(filePath, directory / ("rotated-" + std::to_string(++rotations) + ".log"));
+            }
+
+            file = std::fopen(filePath.c_str(), "wb");
+            fileStart = i;
+            fileSize = 0;
+        }
+
+        std::string line = "[12:00:00] [Client thread/INFO]: [CHAT] line " + std::to_string(i) + "\n";
+
+        if (rng() % 4 == 0) {
+            line = "[12:00:00] [Client thread/INFO]: Sound engine started\n" + line;
+        }
+
+        // the reader sees lines that are only partially written
+        std::size_t split = rng() % line.size();
+        std::fwrite(line.data(), 1, split, file);
+        std::fflush(file);
+        std::fwrite(line.data() + split, 1, line.size() - split, file);
+        std::fflush(file);
+
+        fileSize += line.size();
+
+        if (hold.owns_lock() && fileSize > previousSize) {
+            hold.unlock();
+        }
+    }
+
+    if (hold.owns_lock()) {
+        hold.unlock();
+    }
+
+    if (file) {
+        std::fclose(file);
+    }
+
+    std::printf("Rotated %d times, truncated %d times (%d rewritten past the old size)\n", rotations, truncations, rewrites);
+
+    writing = false;
+}
+
+int main() {
+    const std::filesystem::path directory = "log_tail_test_logs";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    const std::string filePath = (directory / "latest.log").string();
+    std::fclose(std::fopen(filePath.c_str(), "wb"));
+
+    LT::Tail tail(filePath, "[CHAT] ");
+    long long duplicated = 0, lost = 0, malformed = 0;
+
+    auto callback = [&](std::string_view line) {
+        std::size_t number = line.rfind(' ');
+
+        if (number == std::string_view::npos || line.substr(0, number) != "[12:00:00] [Client thread/INFO]: [CHAT] line") {
+            ++malformed;
+            return;
+        }
+
+        long long index = std::stoll(std::string(line.substr(number + 1))), expected = received.load();
+
+        if (index < expected) {
+            ++duplicated;
+            return;
+        }
+
+        lost += index - expected;
+        received = index + 1;
+    };
+
+    std::thread writer(writeLog, std::cref(directory), std::cref(filePath));
+
+    while (writing.load()) {
+        std::lock_guard<std::mutex> lock(readerMutex);
+        tail.read(callback);
+    }
+
+    writer.join();
+    tail.read(callback);
+
+    std::printf("Read %lld of %d lines: %lld lost, %lld duplicated, %lld malformed\n", received.load(), CHAT_LINES, lost,
+                duplicated, malformed);
+
+    std::filesystem::remove_all(directory);
+
+    return !failed && received == CHAT_LINES && lost == 0 && duplicated == 0 && malformed == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+/*
+MIT License
+
+Copyright (c) 2022 sbplat
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Differential test of the vectorized LT::Search functions against their scalar versions
+// (and std::search) on random buffers, with matches around the 16/32 byte block boundaries
+// and in the unaligned tails the vector loops leave over
+
+#include "include/Log_Tail.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+
+int failures = 0;
+
+void check(const char *function, const char *expected, const char *actual, const char *begin, std::size_t size, std::string_view needle) {
+    if (expected == actual) {
+        return;
+    }
+
+    if (++failures <= 10) {
+        std::printf("%s mismatch: size=%zu needle=\"%.*s\" expected=%td actual=%td\n", function, size, (int)needle.size(),
+                    needle.data(), expected - begin, actual - begin);
+    }
+}
+
+// Searches [begin, begin + size) with every function. The buffer is allocated with the exact
+// size so an over-read past the end shows up under a sanitizer
+void compare(const std::string &data, std::size_t offset, std::string_view needle) {
+    std::size_t size = data.size() - offset;
+    std::unique_ptr<char[]> buffer(new char[size + 1]);
+    std::copy(data.begin() + offset, data.end(), buffer.get());
+
+    const char *begin = buffer.get(), *end = begin + size;
+
+    const char *byte = LT::Search::findByteScalar(begin, end, needle.front());
+    check("findByteScalar", std::find(begin, end, needle.front()), byte, begin, size, needle);
+    check("findByte", byte, LT::Search::findByte(begin, end, needle.front()), begin, size, needle);
+
+    const char *string = LT::Search::findStringScalar(begin, end, needle);
+    check("findStringScalar", std::search(begin, end, needle.begin(), needle.end()), string, begin, size, needle);
+    check("findString", string, LT::Search::findString(begin, end, needle), begin, size, needle);
+}
+
+int main() {
+#if defined(__AVX2__)
+    if (!__builtin_cpu_supports("avx2")) {
+        std::printf("AVX2 is not supported by this CPU\n");
+        return 77;
+    }
+
+    const char *instructions = "AVX2";
+#elif defined(__SSE2__)
+    const char *instructions = "SSE2";
+#else
+    const char *instructions = "scalar";
+#endif
+
+    std::mt19937 rng(4);
+    long long cases = 0;
+
+    for (int i = 0; i < 200000; ++i) {
+        // a small alphabet gives partial matches of the needle everywhere
+        std::size_t size = rng() % 300;
+        std::string data(size, ' ');
+
+        for (char &c : data) {
+            c = "ab\n["[rng() % 4];
+        }
+
+        std::string needle(1 + rng() % 40, ' ');
+
+        for (char &c : needle) {
+            c = "ab\n["[rng() % 4];
+        }
+
+        if (size > 0 && rng() % 2 == 0) {
+            // put (part of) the needle across a block boundary or at the end of the buffer
+            std::size_t block = rng() % 2 == 0 ? 16 : 32;
+            std::size_t boundary = rng() % 3 == 0 ? size : (rng() % (size / block + 1)) * block;
+            std::size_t position = boundary - std::min<std::size_t>(boundary, rng() % needle.size() + 1);
+            std::size_t length = std::min(needle.size(), size - position);
+            data.replace(position, length, needle, 0, length);
+        }
+
+        for (std::size_t offset = 0; offset < std::min<std::size_t>(data.size(), 3); ++offset) {
+            compare(data, offset, needle);
+            ++cases;
+        }
+    }
+
+    // a log-like buffer with the marker at every offset within two blocks
+    const std::string marker = "[CHAT] ";
+
+    for (std::size_t position = 0; position < 80; ++position) {
+        for (std::size_t size = position; size < position + marker.size() + 40; ++size) {
+            std::string data(size, '[');
+            data.replace(position, std::min(marker.size(), size - position), marker, 0, std::min(marker.size(), size - position));
+
+            compare(data, 0, marker);
+            compare(data, 0, "\n");
+            ++cases;
+        }
+    }
+
+    std::printf("%s: %lld cases, %d mismatches\n", instructions, cases, failures);
+
+    return failures == 0 ? 0 : 1;
+}